@@ -0,0 +1,331 @@
+#include "employee_batch.h"
+#include "employee_metrics.h"
+using namespace std;
+
+#include <charconv>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+
+namespace {
+
+enum class BatchOp : uint8_t {
+    INSERT,
+    REMOVE,
+    EXTRACT_MAX,
+    PEEK,
+    TOP,
+    UPDATE,
+    SIZE,
+    METRICS,
+    INVALID // didn't parse, problem says why
+};
+
+struct BatchCommand {
+    BatchOp op = BatchOp::INVALID;
+    size_t line = 0;
+    EmployeeSpec spec;      // insert. update and remove only use spec.id
+    size_t count = 0;       // top
+    optional<int> experience; // update
+    optional<QualificationLevel> level;
+    optional<string_view> technology; // parsed once the employee's class is known
+    string_view path;         // metrics
+    const char* problem = nullptr;
+};
+
+// next word on the line, or a "quoted" run. empty once the line is used up
+string_view nextWord(string_view line, size_t& pos) {
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) {
+        pos++;
+    }
+    if (pos >= line.size()) {
+        return string_view();
+    }
+    size_t start = pos;
+    if (line[pos] == '"') {
+        size_t close = line.find('"', pos + 1);
+        if (close == string_view::npos) {
+            close = line.size();
+        }
+        pos = min(close + 1, line.size());
+        return line.substr(start + 1, close - start - 1);
+    }
+    while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r') {
+        pos++;
+    }
+    return line.substr(start, pos - start);
+}
+
+template<class T>
+bool parseNumber(string_view text, T& out) {
+    const char* end = text.data() + text.size();
+    from_chars_result result = from_chars(text.data(), end, out);
+    return !text.empty() && result.ec == errc() && result.ptr == end;
+}
+
+void parseCommand(string_view line, BatchCommand& command) {
+    size_t pos = 0;
+    string_view name = nextWord(line, pos);
+    command.problem = "unknown command";
+
+    if (name == "insert") {
+        string_view id = nextWord(line, pos);
+        command.spec.name = nextWord(line, pos);
+        string_view eClass = nextWord(line, pos);
+        string_view experience = nextWord(line, pos);
+        string_view level = nextWord(line, pos);
+        string_view technology = nextWord(line, pos);
+        if (!parseNumber(id, command.spec.id) || !parseNumber(experience, command.spec.experience)) {
+            command.problem = "usage: insert <id> <name> <class> <experience> [level] [technology]";
+            return;
+        }
+        if (!parseEmployeeClass(eClass, command.spec.eClass)) {
+            command.problem = employeeErrorMessage(EmployeeError::UNKNOWN_CLASS);
+            return;
+        }
+        bool qualified = command.spec.eClass != EmployeeClass::CIO && command.spec.eClass != EmployeeClass::PM;
+        if (qualified && !parseQualificationLevel(level, command.spec.level)) {
+            command.problem = employeeErrorMessage(EmployeeError::UNKNOWN_LEVEL);
+            return;
+        }
+        bool hasTechnology = command.spec.eClass == EmployeeClass::BD || command.spec.eClass == EmployeeClass::FD;
+        if (hasTechnology && !parseTechnology(command.spec.eClass, technology, command.spec.technology)) {
+            command.problem = employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY);
+            return;
+        }
+        command.op = BatchOp::INSERT;
+    } else if (name == "remove") {
+        if (!parseNumber(nextWord(line, pos), command.spec.id)) {
+            command.problem = "usage: remove <id>";
+            return;
+        }
+        command.op = BatchOp::REMOVE;
+    } else if (name == "extractMax") {
+        command.op = BatchOp::EXTRACT_MAX;
+    } else if (name == "peek") {
+        command.op = BatchOp::PEEK;
+    } else if (name == "size") {
+        command.op = BatchOp::SIZE;
+    } else if (name == "metrics") {
+        command.path = nextWord(line, pos);
+        if (command.path.empty()) {
+            command.problem = "usage: metrics <path>";
+            return;
+        }
+        command.op = BatchOp::METRICS;
+    } else if (name == "top") {
+        if (!parseNumber(nextWord(line, pos), command.count) || command.count == 0) {
+            command.problem = "usage: top <k>, k at least 1"; //top 0 would print "empty" for a queue that isn't
+            return;
+        }
+        command.op = BatchOp::TOP;
+    } else if (name == "update") {
+        if (!parseNumber(nextWord(line, pos), command.spec.id)) {
+            command.problem = "usage: update <id> [experience <months>] [level <LEVEL>] [technology <TECH>]";
+            return;
+        }
+        for (string_view field = nextWord(line, pos); !field.empty(); field = nextWord(line, pos)) {
+            string_view value = nextWord(line, pos);
+            int months = 0;
+            QualificationLevel level;
+            if (field == "experience" && parseNumber(value, months)) {
+                command.experience = months;
+            } else if (field == "level" && parseQualificationLevel(value, level)) {
+                command.level = level;
+            } else if (field == "technology" && !value.empty()) {
+                command.technology = value;
+            } else {
+                command.problem = "usage: update <id> [experience <months>] [level <LEVEL>] [technology <TECH>]";
+                return;
+            }
+        }
+        command.op = BatchOp::UPDATE;
+    } else {
+        return;
+    }
+    if (!nextWord(line, pos).empty()) {
+        command.op = BatchOp::INVALID;
+        command.problem = "too many arguments";
+        return;
+    }
+    command.problem = nullptr;
+}
+
+vector<BatchCommand> parseScript(string_view script) {
+    vector<BatchCommand> commands;
+    commands.reserve(script.size() / 16); //rough guess, commands are short
+    size_t lineNumber = 0;
+    for (size_t pos = 0; pos < script.size();) {
+        size_t end = script.find('\n', pos);
+        if (end == string_view::npos) {
+            end = script.size();
+        }
+        string_view line = script.substr(pos, end - pos);
+        pos = end + 1;
+        lineNumber++;
+
+        size_t hash = line.find('#');
+        if (hash != string_view::npos) {
+            line = line.substr(0, hash);
+        }
+        size_t probe = 0;
+        if (nextWord(line, probe).empty()) {
+            continue; //blank or comment only
+        }
+        BatchCommand& command = commands.emplace_back();
+        command.line = lineNumber;
+        parseCommand(line, command);
+    }
+    return commands;
+}
+
+void writeEmployee(ExportWriter& out, const Employee& employee) {
+    out.writeInt(employee.getEmployeeId());
+    out.writeChar(' ');
+    out.write(employee.getName());
+    out.writeChar(' ');
+    out.writeFixed(employee.getSalary(), 2);
+    out.writeChar('\n');
+}
+
+void writeError(ExportWriter& out, size_t line, string_view problem) {
+    out.write("error line ");
+    out.writeInt(static_cast<long long>(line));
+    out.write(": ");
+    out.write(problem);
+    out.writeChar('\n');
+}
+
+// everything is checked before the first setter runs, so a failed update leaves the employee as it was
+void applyUpdate(Employee& employee, const BatchCommand& command) {
+    QualifiedEmployee* qualified = dynamic_cast<QualifiedEmployee*>(&employee);
+    if (command.level && !qualified) {
+        throw invalid_argument("employee has no qualification level");
+    }
+    uint8_t technology = 0;
+    if (command.technology && !parseTechnology(employee.getEmployeeClass(), *command.technology, technology)) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY));
+    }
+    if (command.experience && *command.experience < 0) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::NEGATIVE_EXPERIENCE));
+    }
+
+    if (command.level) {
+        qualified->setQualificationLevel(*command.level);
+    }
+    if (command.technology) {
+        if (BackendDeveloper* backend = dynamic_cast<BackendDeveloper*>(&employee)) {
+            backend->setTechnology(static_cast<BackendTechnology>(technology));
+        } else if (FrontendDeveloper* frontend = dynamic_cast<FrontendDeveloper*>(&employee)) {
+            frontend->setTechnology(static_cast<FrontendTechnology>(technology));
+        }
+    }
+    if (command.experience) {
+        employee.setExperience(*command.experience);
+    }
+}
+
+}
+
+BatchReport runBatch(string_view script, EmployeePriorityQueue& queue, EmployeePool& pool, ExportWriter& out) {
+    auto start = chrono::steady_clock::now();
+    vector<BatchCommand> commands = parseScript(script);
+
+    BatchReport report;
+    report.commands = commands.size();
+    for (size_t i = 0; i < commands.size(); i++) {
+        const BatchCommand& command = commands[i];
+        switch (command.op) {
+            case BatchOp::INSERT: {
+                // the non throwing path, a bad insert costs the same as a good one
+                EmployeeResult created = pool.tryCreate(command.spec);
+                EmployeeError error = created ? queue.tryInsert(move(created.employee)) : created.error;
+                if (error != EmployeeError::NONE) {
+                    writeError(out, command.line, employeeErrorMessage(error));
+                    report.failed++;
+                }
+                break;
+            }
+            case BatchOp::REMOVE: {
+                // a run of removes (a layoff list) goes in as one removeBatch. an id that isn't there, or is
+                // repeated in the run, fails on its own line like it would one remove at a time
+                size_t end = i;
+                while (end < commands.size() && commands[end].op == BatchOp::REMOVE) {
+                    end++;
+                }
+                vector<int> ids;
+                ids.reserve(end - i);
+                unordered_set<int> seen;
+                for (size_t j = i; j < end; j++) {
+                    int employeeId = commands[j].spec.id;
+                    if (!queue.contains(employeeId) || !seen.insert(employeeId).second) {
+                        writeError(out, commands[j].line, "employee not found");
+                        report.failed++;
+                    } else {
+                        ids.push_back(employeeId);
+                    }
+                }
+                queue.removeBatch(ids);
+                i = end - 1;
+                break;
+            }
+            case BatchOp::EXTRACT_MAX: {
+                EmployeeHandle top = queue.extractMax();
+                if (top) {
+                    writeEmployee(out, *top);
+                } else {
+                    out.write("empty\n");
+                }
+                break;
+            }
+            case BatchOp::PEEK:
+                if (const Employee* top = queue.peek()) {
+                    writeEmployee(out, *top);
+                } else {
+                    out.write("empty\n");
+                }
+                break;
+            case BatchOp::TOP: {
+                vector<const Employee*> best = queue.topK(command.count);
+                if (best.empty()) {
+                    out.write("empty\n");
+                }
+                for (const Employee* employee : best) {
+                    writeEmployee(out, *employee);
+                }
+                break;
+            }
+            case BatchOp::UPDATE:
+                try {
+                    queue.updateEmployee(command.spec.id, [&](Employee& employee) {
+                        applyUpdate(employee, command);
+                    });
+                } catch (const invalid_argument& e) {
+                    writeError(out, command.line, e.what());
+                    report.failed++;
+                }
+                break;
+            case BatchOp::SIZE:
+                out.writeInt(static_cast<long long>(queue.size()));
+                out.writeChar('\n');
+                break;
+            case BatchOp::METRICS:
+                try {
+                    writeMetrics(string(command.path), &queue);
+                } catch (const runtime_error& e) {
+                    writeError(out, command.line, e.what());
+                    report.failed++;
+                }
+                break;
+            case BatchOp::INVALID:
+                writeError(out, command.line, command.problem);
+                report.failed++;
+                break;
+        }
+    }
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,36 @@
+#ifndef EMPLOYEE_BATCH_H
+#define EMPLOYEE_BATCH_H
+
+#include "employee_management.h"
+#include "employee_pool.h"
+#include "employee_export.h"
+#include <string_view>
+using namespace std;
+
+// command scripts for running a queue without the interactive prompts. one command per line,
+// words separated by spaces or tabs, # starts a comment:
+//
+//   insert <id> <name> <class> <experience> [level] [technology]   e.g. insert 7 "Ann Lee" BD 24 SENIOR NET
+//   remove <id>
+//   extractMax
+//   peek
+//   top <k>            k >= 1
+//   update <id> [experience <months>] [level <LEVEL>] [technology <TECH>]
+//   size
+//   metrics <path>     Prometheus text dump of the queue metrics (see employee_metrics.h)
+//
+// consecutive remove lines run as one removeBatch, with the same output as one at a time.
+// names with spaces go in "quotes". extractMax, peek and top print one "<id> <name> <salary>" line per employee
+// ("empty" if there's none), size prints the count. a command that fails prints "error line <n>: <why>"
+// and the script carries on, so the same script on the same start state always gives the same output
+struct BatchReport {
+    size_t commands = 0; // commands run, parse failures included
+    size_t failed = 0;
+    double seconds = 0.0;
+};
+
+// the whole script is parsed first (names stay views into it), then run against the queue.
+// output goes through the writer, nothing is flushed per command
+BatchReport runBatch(string_view script, EmployeePriorityQueue& queue, EmployeePool& pool, ExportWriter& out);
+
+#endif
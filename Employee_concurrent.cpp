@@ -0,0 +1,158 @@
+#include "employee_concurrent.h"
+using namespace std;
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+
+ConcurrentEmployeeQueue::Shard::Shard() : topSalary(-numeric_limits<double>::infinity()) {}
+
+// called with the shard locked after every change
+void ConcurrentEmployeeQueue::Shard::refreshTop() {
+    const vector<HeapEntry>& heap = queue.getHeap();
+    topSalary.store(heap.empty() ? -numeric_limits<double>::infinity() : heap.front().salary,
+                    memory_order_release);
+}
+
+ConcurrentEmployeeQueue::ConcurrentEmployeeQueue(size_t shardCount, bool strict) : strict(strict) {
+    if (shardCount == 0) {
+        shardCount = 2 * max(1u, thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(make_unique<Shard>());
+    }
+}
+
+ConcurrentEmployeeQueue::Shard& ConcurrentEmployeeQueue::shardFor(int employeeId) const {
+    // mix the id so runs of consecutive ids spread over all shards
+    uint64_t mixed = static_cast<uint64_t>(static_cast<uint32_t>(employeeId)) * 0x9E3779B97F4A7C15ull;
+    return *shards[(mixed >> 32) % shards.size()];
+}
+
+void ConcurrentEmployeeQueue::insert(EmployeeHandle employee) {
+    if (!employee) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::NULL_EMPLOYEE));
+    }
+    Shard& shard = shardFor(employee->getEmployeeId());
+    lock_guard<mutex> guard(shard.lock);
+    shard.queue.insert(move(employee));
+    shard.refreshTop();
+}
+
+void ConcurrentEmployeeQueue::remove(int employeeId) {
+    Shard& shard = shardFor(employeeId);
+    lock_guard<mutex> guard(shard.lock);
+    shard.queue.remove(employeeId);
+    shard.refreshTop();
+}
+
+bool ConcurrentEmployeeQueue::contains(int employeeId) const {
+    Shard& shard = shardFor(employeeId);
+    lock_guard<mutex> guard(shard.lock);
+    return shard.queue.contains(employeeId);
+}
+
+EmployeeHandle ConcurrentEmployeeQueue::extractMax() {
+    return strict ? extractStrict() : extractRelaxed();
+}
+
+// lock everything (always in index order, so two strict callers can't deadlock) and take the real max
+EmployeeHandle ConcurrentEmployeeQueue::extractStrict() {
+    vector<unique_lock<mutex>> locks;
+    locks.reserve(shards.size());
+    Shard* best = nullptr;
+    for (const unique_ptr<Shard>& shard : shards) {
+        locks.emplace_back(shard->lock);
+        const vector<HeapEntry>& heap = shard->queue.getHeap();
+        if (!heap.empty() && (!best || best->queue.getHeap().front().salary < heap.front().salary)) {
+            best = shard.get();
+        }
+    }
+    if (!best) {
+        return nullptr;
+    }
+    EmployeeHandle employee = best->queue.extractMax();
+    best->refreshTop();
+    return employee;
+}
+
+// two random shards, take from the one with the better top. a busy shard is skipped instead of waited on
+EmployeeHandle ConcurrentEmployeeQueue::extractRelaxed() {
+    thread_local mt19937 rng(random_device{}());
+    const double empty = -numeric_limits<double>::infinity();
+    const size_t count = shards.size();
+
+    for (size_t attempt = 0;; attempt++) {
+        Shard* a = shards[rng() % count].get();
+        Shard* b = shards[rng() % count].get();
+        Shard* pick = a->topSalary.load(memory_order_acquire) >= b->topSalary.load(memory_order_acquire) ? a : b;
+
+        if (pick->topSalary.load(memory_order_acquire) == empty) {
+            // both looked empty. only give up after a full scan agrees everything is empty
+            if (attempt % count == count - 1 || count <= 2) {
+                bool allEmpty = true;
+                for (const unique_ptr<Shard>& shard : shards) {
+                    if (shard->topSalary.load(memory_order_acquire) != empty) {
+                        allEmpty = false;
+                        break;
+                    }
+                }
+                if (allEmpty) {
+                    return nullptr;
+                }
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(pick->lock, try_to_lock);
+        if (!guard.owns_lock()) {
+            continue; //someone else is on it, try another pair
+        }
+        EmployeeHandle employee = pick->queue.extractMax();
+        pick->refreshTop();
+        if (employee) {
+            return employee;
+        }
+    }
+}
+
+optional<EmployeeKey> ConcurrentEmployeeQueue::peek() const {
+    if (strict) {
+        vector<unique_lock<mutex>> locks;
+        locks.reserve(shards.size());
+        optional<EmployeeKey> best;
+        for (const unique_ptr<Shard>& shard : shards) {
+            locks.emplace_back(shard->lock);
+            const vector<HeapEntry>& heap = shard->queue.getHeap();
+            if (!heap.empty() && (!best || best->salary < heap.front().salary)) {
+                best = EmployeeKey{heap.front().employeeId, heap.front().salary};
+            }
+        }
+        return best;
+    }
+
+    // relaxed: find the best looking shard from the atomics, then read its top under its lock
+    Shard* best = nullptr;
+    for (const unique_ptr<Shard>& shard : shards) {
+        if (!best || best->topSalary.load(memory_order_acquire) < shard->topSalary.load(memory_order_acquire)) {
+            best = shard.get();
+        }
+    }
+    lock_guard<mutex> guard(best->lock);
+    const vector<HeapEntry>& heap = best->queue.getHeap();
+    if (heap.empty()) {
+        return nullopt;
+    }
+    return EmployeeKey{heap.front().employeeId, heap.front().salary};
+}
+
+size_t ConcurrentEmployeeQueue::size() const {
+    size_t total = 0;
+    for (const unique_ptr<Shard>& shard : shards) {
+        lock_guard<mutex> guard(shard->lock);
+        total += shard->queue.size();
+    }
+    return total;
+}
@@ -0,0 +1,62 @@
+#ifndef EMPLOYEE_CONCURRENT_H
+#define EMPLOYEE_CONCURRENT_H
+
+#include "employee_management.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+using namespace std;
+
+// what peek hands out. a pointer to the Employee could dangle as soon as the shard is unlocked
+struct EmployeeKey {
+    int employeeId;
+    double salary;
+};
+
+// priority queue for many producer/consumer threads: several EmployeePriorityQueue shards, each behind its own lock.
+// an id always lives in the same shard, so insert/remove/contains only ever lock one shard.
+//
+// relaxed mode (default): extractMax looks at two random shards and takes the better top (the "multiqueue" trick).
+// it scales with threads but only returns something near the max. strict mode locks every shard and returns
+// the exact global max, like a single queue would
+class ConcurrentEmployeeQueue {
+private:
+    struct Shard {
+        mutex lock;
+        EmployeePriorityQueue queue;
+        atomic<double> topSalary; // read without the lock to pick shards, -infinity when empty
+
+        Shard();
+        void refreshTop();
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    bool strict;
+
+    Shard& shardFor(int employeeId) const;
+    EmployeeHandle extractStrict();
+    EmployeeHandle extractRelaxed();
+
+public:
+    explicit ConcurrentEmployeeQueue(size_t shardCount = 0, bool strict = false); // 0 = two per core
+
+    // same API as EmployeePriorityQueue, all thread safe
+    void insert(EmployeeHandle employee); // throws on null/duplicate id like the plain queue
+    EmployeeHandle extractMax();          // nullptr when empty
+    optional<EmployeeKey> peek() const;   // exact in strict mode, best shard top in relaxed mode
+    void remove(int employeeId);          // throws if not found
+    bool contains(int employeeId) const;
+
+    size_t size() const; // adds up the shards, can be stale by the time it returns
+    bool isEmpty() const { return size() == 0; }
+    size_t shardCount() const { return shards.size(); }
+    bool isStrict() const { return strict; }
+
+    // employees have to be safe to destroy on any thread: use new, or a pool only this queue's threads share
+    ConcurrentEmployeeQueue(const ConcurrentEmployeeQueue&) = delete;
+    ConcurrentEmployeeQueue& operator=(const ConcurrentEmployeeQueue&) = delete;
+};
+
+#endif
@@ -0,0 +1,313 @@
+#include "employee_export.h"
+using namespace std;
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+ExportWriter::ExportWriter(int fd, size_t bufferSize) : fd(fd), buffer(max<size_t>(bufferSize, 4096)) {}
+
+ExportWriter::~ExportWriter() {
+    try {
+        flush();
+    } catch (...) {
+        // nothing to do about it here
+    }
+}
+
+void ExportWriter::makeRoom(size_t n) {
+    flush();
+    if (buffer.size() < n) {
+        buffer.resize(n); //one huge field, rare enough to just grow for it
+    }
+}
+
+void ExportWriter::writeInt(long long value) {
+    char* out = reserve(24);
+    used += to_chars(out, out + 24, value).ptr - out;
+}
+
+// most values go through integer formatting: scale, round, print the digits with a '.' put in.
+// that's only done when the scaled value is small enough to hold its error under 1e-7 and isn't within 1e-6
+// of a rounding tie, so the digits always come out the same as to_chars/printf would give
+void ExportWriter::writeFixed(double value, int precision) {
+    static const double scales[] = {1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0};
+    if (precision >= 0 && precision <= 6) {
+        double scaled = fabs(value) * scales[precision];
+        double whole = floor(scaled);
+        double fraction = scaled - whole;
+        if (scaled < 1e9 && fabs(fraction - 0.5) > 1e-6) {
+            uint64_t digits = static_cast<uint64_t>(whole) + (fraction > 0.5 ? 1 : 0);
+            uint64_t scale = static_cast<uint64_t>(scales[precision]);
+            char* out = reserve(32);
+            char* end = out;
+            if (signbit(value)) {
+                *end++ = '-'; //printf keeps the sign of a negative that rounds to 0 too
+            }
+            end = to_chars(end, out + 32, digits / scale).ptr;
+            if (precision > 0) {
+                *end++ = '.';
+                uint64_t rest = digits % scale;
+                for (int i = precision - 1; i >= 0; i--) {
+                    end[i] = static_cast<char>('0' + rest % 10);
+                    rest /= 10;
+                }
+                end += precision;
+            }
+            used += end - out;
+            return;
+        }
+    }
+
+    const size_t room = 350; //%.Nf of the biggest double is ~310 digits
+    char* out = reserve(room);
+    to_chars_result result = to_chars(out, out + room, value, chars_format::fixed, precision);
+    used += result.ptr - out;
+}
+
+void ExportWriter::writePadded(string_view text, size_t width) {
+    size_t padding = text.size() < width ? width - text.size() : 0;
+    char* out = reserve(padding + text.size());
+    memset(out, ' ', padding);
+    memcpy(out + padding, text.data(), text.size());
+    used += padding + text.size();
+}
+
+void ExportWriter::flush() {
+    size_t done = 0;
+    while (done < used) {
+        ssize_t written = ::write(fd, buffer.data() + done, used - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            used -= done; //keep what didn't go out, so a retry doesn't duplicate rows
+            memmove(buffer.data(), buffer.data() + done, used);
+            throw runtime_error(string("export write failed: ") + strerror(errno));
+        }
+        done += static_cast<size_t>(written);
+    }
+    used = 0;
+}
+
+namespace {
+
+// quoted only when it has to be, quotes inside are doubled
+void writeCsvField(ExportWriter& out, string_view text) {
+    if (text.find_first_of(",\"\r\n") == string_view::npos) {
+        out.write(text);
+        return;
+    }
+    out.writeChar('"');
+    for (size_t start = 0;;) {
+        size_t quote = text.find('"', start);
+        out.write(text.substr(start, quote == string_view::npos ? string_view::npos : quote + 1 - start));
+        if (quote == string_view::npos) {
+            break;
+        }
+        out.writeChar('"');
+        start = quote + 1;
+    }
+    out.writeChar('"');
+}
+
+void writeJsonString(ExportWriter& out, string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out.writeChar('"');
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.write(text.substr(start, i - start)); //the plain run before this character
+        if (c == '"' || c == '\\') {
+            out.writeChar('\\');
+            out.writeChar(static_cast<char>(c));
+        } else {
+            char escape[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.write(string_view(escape, sizeof(escape)));
+        }
+        start = i + 1;
+    }
+    out.write(text.substr(start));
+    out.writeChar('"');
+}
+
+void writeCsvRow(ExportWriter& out, const EmployeeSpec& spec, double salary) {
+    bool qualified = spec.eClass != EmployeeClass::CIO && spec.eClass != EmployeeClass::PM;
+    out.writeInt(spec.id);
+    out.writeChar(',');
+    writeCsvField(out, spec.name);
+    out.writeChar(',');
+    out.write(employeeClassName(spec.eClass));
+    out.writeChar(',');
+    out.writeInt(spec.experience);
+    out.writeChar(',');
+    if (qualified) {
+        out.write(qualificationLevelName(spec.level));
+    }
+    out.writeChar(',');
+    out.write(technologyName(spec.eClass, spec.technology));
+    out.writeChar(',');
+    out.writeFixed(salary, 2);
+    out.writeChar('\n');
+}
+
+void writeJsonRow(ExportWriter& out, const EmployeeSpec& spec, double salary) {
+    out.write("{\"id\":");
+    out.writeInt(spec.id);
+    out.write(",\"name\":");
+    writeJsonString(out, spec.name);
+    out.write(",\"class\":\"");
+    out.write(employeeClassName(spec.eClass));
+    out.write("\",\"experience\":");
+    out.writeInt(spec.experience);
+    if (spec.eClass != EmployeeClass::CIO && spec.eClass != EmployeeClass::PM) {
+        out.write(",\"level\":\"");
+        out.write(qualificationLevelName(spec.level));
+        out.writeChar('"');
+    }
+    string_view technology = technologyName(spec.eClass, spec.technology);
+    if (!technology.empty()) {
+        out.write(",\"technology\":\"");
+        out.write(technology);
+        out.writeChar('"');
+    }
+    out.write(",\"salary\":");
+    out.writeFixed(salary, 2);
+    out.write("}\n");
+}
+
+// same columns and widths as printEmployeeTableHeader/printEmployeeRow
+void writeTableHeader(ExportWriter& out) {
+    out.write("\nEmployee priority queue (salary):\n");
+    out.writePadded("ID", 5);
+    out.writePadded("name", 20);
+    out.writePadded("salary", 15);
+    out.writePadded("exp\n", 15);
+    out.write(string(55, '-'));
+    out.writeChar('\n');
+}
+
+void writeTableRow(ExportWriter& out, const EmployeeSpec& spec, double salary) {
+    char number[32];
+    char* end = to_chars(number, number + sizeof(number), spec.id).ptr;
+    out.writePadded(string_view(number, end - number), 5);
+    out.writePadded(spec.name, 20);
+    end = to_chars(number, number + sizeof(number), salary, chars_format::fixed, 2).ptr;
+    out.writePadded(string_view(number, end - number), 15);
+    end = to_chars(number, number + sizeof(number), spec.experience).ptr;
+    out.writePadded(string_view(number, end - number), 15);
+    out.write(" months\n");
+}
+
+void writeHeader(ExportWriter& out, const ExportOptions& options) {
+    if (options.header) {
+        if (options.format == ExportFormat::CSV) {
+            out.write("id,name,class,experience,level,technology,salary\n");
+        } else if (options.format == ExportFormat::TABLE) {
+            writeTableHeader(out);
+        }
+    }
+}
+
+void writeRow(ExportWriter& out, const ExportOptions& options, const EmployeeSpec& spec, double salary) {
+    switch (options.format) {
+        case ExportFormat::CSV: writeCsvRow(out, spec, salary); break;
+        case ExportFormat::JSON_LINES: writeJsonRow(out, spec, salary); break;
+        case ExportFormat::TABLE: writeTableRow(out, spec, salary); break;
+    }
+}
+
+// opens path for one of the fd exports and closes it again, errors as runtime_error
+template<class Export>
+size_t exportToPath(const string& path, Export exportTo) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw runtime_error("can't create " + path + ": " + strerror(errno));
+    }
+    size_t rows;
+    try {
+        rows = exportTo(fd);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    if (close(fd) != 0) {
+        throw runtime_error("can't close " + path + ": " + strerror(errno));
+    }
+    return rows;
+}
+
+}
+
+size_t exportQueue(const EmployeePriorityQueue& queue, int fd, const ExportOptions& options) {
+    ExportWriter out(fd, options.bufferSize);
+    writeHeader(out, options);
+
+    // the sorted view is cached in the queue, so exporting twice without changes sorts once
+    const vector<HeapEntry>& entries = options.sorted ? queue.getSortedHeap() : queue.getHeap();
+    // in sorted order every row misses the cache three times: payload slot, employee, name. one row's formatting
+    // is too long for the cpu to run ahead to the next row's loads, so each is prefetched a few rows early
+    const size_t SlotAhead = 24;
+    const size_t EmployeeAhead = 16;
+    const size_t NameAhead = 8;
+    size_t rows = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i + SlotAhead < entries.size()) {
+            queue.prefetchEmployee(entries[i + SlotAhead]);
+        }
+        if (i + EmployeeAhead < entries.size()) {
+            __builtin_prefetch(queue.getEmployee(entries[i + EmployeeAhead]));
+        }
+        if (i + NameAhead < entries.size()) {
+            if (const Employee* ahead = queue.getEmployee(entries[i + NameAhead])) {
+                __builtin_prefetch(ahead->getName().data());
+            }
+        }
+        const Employee* employee = queue.getEmployee(entries[i]);
+        if (!employee) {
+            continue; //a tombstone, only the unsorted heap has them
+        }
+        writeRow(out, options, employee->describe(), employee->getSalary());
+        rows++;
+    }
+    out.flush();
+    return rows;
+}
+
+size_t exportQueue(const EmployeePriorityQueue& queue, const string& path, const ExportOptions& options) {
+    return exportToPath(path, [&](int fd) {
+        return exportQueue(queue, fd, options);
+    });
+}
+
+// rows are copies, so there's nothing to prefetch. unsorted is slot order
+size_t exportVersion(const QueueVersion& version, int fd, const ExportOptions& options) {
+    ExportWriter out(fd, options.bufferSize);
+    writeHeader(out, options);
+    if (options.sorted) {
+        for (const EmployeeRow& row : version.sortedRows()) {
+            writeRow(out, options, row.spec, row.salary);
+        }
+    } else {
+        version.forEach([&](const EmployeeRow& row) {
+            writeRow(out, options, row.spec, row.salary);
+        });
+    }
+    out.flush();
+    return version.size();
+}
+
+size_t exportVersion(const QueueVersion& version, const string& path, const ExportOptions& options) {
+    return exportToPath(path, [&](int fd) {
+        return exportVersion(version, fd, options);
+    });
+}
@@ -0,0 +1,69 @@
+#ifndef EMPLOYEE_EXPORT_H
+#define EMPLOYEE_EXPORT_H
+
+#include "employee_management.h"
+#include "employee_versions.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// buffered writer on a raw file descriptor. numbers are formatted with to_chars straight into the buffer,
+// and the buffer only goes out in big write() calls, so a large export costs few syscalls and no allocations
+class ExportWriter {
+private:
+    int fd;
+    vector<char> buffer;
+    size_t used = 0;
+    void makeRoom(size_t n); // flushes, grows the buffer if n still doesn't fit
+
+public:
+    explicit ExportWriter(int fd, size_t bufferSize = 1 << 20); // the fd stays open, it isn't ours
+    ~ExportWriter(); // flushes what's left. errors can't be reported from here, call flush() first to see them
+
+    // room for n more bytes, advance() after writing into it. inline since every field goes through here
+    char* reserve(size_t n) {
+        if (buffer.size() - used < n) {
+            makeRoom(n);
+        }
+        return buffer.data() + used;
+    }
+    void advance(size_t n) { used += n; }
+
+    void write(string_view text) {
+        memcpy(reserve(text.size()), text.data(), text.size());
+        used += text.size();
+    }
+    void writeChar(char c) { *reserve(1) = c; used++; }
+    void writeInt(long long value);
+    void writeFixed(double value, int precision); // like fixed << setprecision(precision)
+    void writePadded(string_view text, size_t width); // right aligned, like setw(width)
+    void flush(); // throws runtime_error if the fd won't take the data
+
+    ExportWriter(const ExportWriter&) = delete;
+    ExportWriter& operator=(const ExportWriter&) = delete;
+};
+
+enum class ExportFormat {
+    CSV,        // id,name,class,experience,level,technology,salary. importRoster reads it back
+    JSON_LINES, // one object per line
+    TABLE       // the fixed width table print() shows
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::CSV;
+    bool sorted = true;          // highest salary first. false writes heap order and skips sorting entirely
+    bool header = true;          // CSV header line / table heading. JSON lines never has one
+    size_t bufferSize = 1 << 20;
+};
+
+// writes every employee in the queue, returns how many rows were written. throws runtime_error on write errors
+size_t exportQueue(const EmployeePriorityQueue& queue, int fd, const ExportOptions& options = ExportOptions());
+size_t exportQueue(const EmployeePriorityQueue& queue, const string& path, const ExportOptions& options = ExportOptions());
+
+// same output from a snapshot (EmployeePriorityQueue::snapshot), so a long export doesn't hold up the queue's writer
+size_t exportVersion(const QueueVersion& version, int fd, const ExportOptions& options = ExportOptions());
+size_t exportVersion(const QueueVersion& version, const string& path, const ExportOptions& options = ExportOptions());
+
+#endif
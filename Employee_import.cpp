@@ -0,0 +1,276 @@
+#include "employee_import.h"
+#include "employee_names.h"
+using namespace std;
+
+#include <algorithm>
+#include <deque>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedFile::MappedFile(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("can't open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw runtime_error("can't stat " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) { //mmap refuses empty files, an empty view is fine for those
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("can't map " + path);
+        }
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd); //the mapping stays valid without the descriptor
+}
+
+MappedFile::~MappedFile() {
+    if (data) {
+        munmap(const_cast<char*>(data), length);
+    }
+}
+
+
+namespace {
+
+// a parsed row, the name still points into the mapped file (or into unescapedNames)
+struct ParsedRow {
+    EmployeeSpec spec;
+    size_t line; // line within the chunk for now, made global after the threads finish
+};
+
+struct ChunkResult {
+    vector<ParsedRow> rows;
+    deque<string> unescapedNames; // names that had "" in them. a deque so the views stay put
+    vector<ImportError> errors;
+    size_t rowsRead = 0;
+    size_t lines = 0;
+};
+
+const size_t FieldCount = 7; // the 7th, salary as exportQueue writes it, is optional and ignored
+
+// splits one line into fields without copying. returns an error message or nullptr
+const char* splitFields(string_view line, char delimiter, string_view (&fields)[FieldCount]) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (true) {
+        if (count == FieldCount) {
+            return "too many fields";
+        }
+        string_view field;
+        if (pos < line.size() && line[pos] == '"') {
+            size_t close = line.find('"', pos + 1);
+            while (close != string_view::npos && close + 1 < line.size() && line[close + 1] == '"') {
+                close = line.find('"', close + 2); //"" is a quote inside the field, still escaped here
+            }
+            if (close == string_view::npos) {
+                return "unterminated quote";
+            }
+            field = line.substr(pos + 1, close - pos - 1);
+            pos = close + 1;
+            if (pos < line.size() && line[pos] != delimiter) {
+                return "text after closing quote";
+            }
+        } else {
+            size_t end = line.find(delimiter, pos);
+            if (end == string_view::npos) {
+                end = line.size();
+            }
+            field = line.substr(pos, end - pos);
+            pos = end;
+        }
+        fields[count++] = field;
+        if (pos >= line.size()) {
+            break;
+        }
+        pos++; //skip the delimiter
+    }
+    return count >= FieldCount - 1 ? nullptr : "expected 6 fields";
+}
+
+bool parseInt(string_view text, int& out) {
+    const char* end = text.data() + text.size();
+    from_chars_result result = from_chars(text.data(), end, out);
+    return result.ec == errc() && result.ptr == end;
+}
+
+// only checks the text format, the employee rules are validateEmployee's job
+const char* parseRow(string_view line, char delimiter, EmployeeSpec& spec, deque<string>& unescapedNames) {
+    string_view fields[FieldCount];
+    if (const char* problem = splitFields(line, delimiter, fields)) {
+        return problem;
+    }
+    if (!parseInt(fields[0], spec.id)) {
+        return "bad id";
+    }
+    spec.name = fields[1];
+    if (spec.name.find("\"\"") != string_view::npos) {
+        string& name = unescapedNames.emplace_back();
+        for (size_t i = 0; i < spec.name.size(); i++) {
+            name += spec.name[i];
+            i += spec.name[i] == '"'; //keep one of the pair
+        }
+        spec.name = name;
+    }
+    if (!parseEmployeeClass(fields[2], spec.eClass)) {
+        return employeeErrorMessage(EmployeeError::UNKNOWN_CLASS);
+    }
+    if (!parseInt(fields[3], spec.experience)) {
+        return "bad experience";
+    }
+
+    spec.level = QualificationLevel::JUNIOR;
+    spec.technology = 0;
+    bool qualified = spec.eClass != EmployeeClass::CIO && spec.eClass != EmployeeClass::PM;
+    if (qualified && !parseQualificationLevel(fields[4], spec.level)) {
+        return employeeErrorMessage(EmployeeError::UNKNOWN_LEVEL);
+    }
+    bool hasTechnology = spec.eClass == EmployeeClass::BD || spec.eClass == EmployeeClass::FD;
+    if (hasTechnology && !parseTechnology(spec.eClass, fields[5], spec.technology)) {
+        return employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY);
+    }
+    return nullptr;
+}
+
+void parseChunk(string_view chunk, char delimiter, bool skipHeader, ChunkResult& result) {
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        size_t end = chunk.find('\n', pos);
+        if (end == string_view::npos) {
+            end = chunk.size();
+        }
+        string_view line = chunk.substr(pos, end - pos);
+        pos = end + 1;
+        result.lines++;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (skipHeader && result.lines == 1 && line.substr(0, 2) == "id") {
+            continue;
+        }
+
+        result.rowsRead++;
+        ParsedRow row;
+        row.line = result.lines;
+        if (const char* problem = parseRow(line, delimiter, row.spec, result.unescapedNames)) {
+            result.errors.push_back({row.line, problem});
+        } else {
+            result.rows.push_back(row);
+        }
+    }
+}
+
+} // namespace
+
+
+ImportReport importRoster(const string& path, EmployeePriorityQueue& queue, EmployeePool& pool,
+                          const ImportOptions& options) {
+    auto start = chrono::steady_clock::now();
+    ImportReport report;
+    MappedFile file(path);
+    string_view text = file.contents();
+
+    char delimiter = options.delimiter;
+    if (delimiter == 0) {
+        string_view firstLine = text.substr(0, text.find('\n'));
+        delimiter = firstLine.find('\t') != string_view::npos ? '\t' : ',';
+    }
+
+    // at least 1MB per chunk, otherwise starting threads costs more than it saves
+    size_t threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+    threads = max<size_t>(1, min(threads, text.size() / (1 << 20) + 1));
+
+    // chunk boundaries always land right after a line break
+    vector<string_view> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= threads && begin < text.size(); i++) {
+        size_t end = i == threads ? text.size() : text.size() * i / threads;
+        if (end < begin) {
+            end = begin;
+        }
+        size_t lineBreak = text.find('\n', end);
+        end = (i == threads || lineBreak == string_view::npos) ? text.size() : lineBreak + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    vector<ChunkResult> results(chunks.size());
+    vector<thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(parseChunk, chunks[i], delimiter, false, ref(results[i]));
+    }
+    if (!chunks.empty()) {
+        parseChunk(chunks[0], delimiter, true, results[0]); //this thread does the first chunk itself
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    // chunks only know their own line numbers, shift them by the lines before the chunk
+    size_t totalRows = 0;
+    size_t lineOffset = 0;
+    for (ChunkResult& result : results) {
+        for (ParsedRow& row : result.rows) {
+            row.line += lineOffset;
+        }
+        for (ImportError& error : result.errors) {
+            error.line += lineOffset;
+        }
+        lineOffset += result.lines;
+        totalRows += result.rows.size();
+        report.rowsRead += result.rowsRead;
+    }
+
+    // building objects isn't parallel (the pool isn't thread safe). nothing here throws on bad data,
+    // rejects from validation and from the queue (duplicate ids) are just collected
+    vector<EmployeeHandle> batch;
+    vector<size_t> batchLines;
+    batch.reserve(totalRows);
+    employeeNames().reserve(employeeNames().size() + totalRows);
+    batchLines.reserve(totalRows);
+    for (ChunkResult& result : results) {
+        for (const ParsedRow& row : result.rows) {
+            EmployeeResult created = pool.tryCreate(row.spec);
+            if (!created) {
+                report.errors.push_back({row.line, employeeErrorMessage(created.error)});
+                continue;
+            }
+            batch.push_back(move(created.employee));
+            batchLines.push_back(row.line);
+        }
+        report.errors.insert(report.errors.end(), result.errors.begin(), result.errors.end());
+        vector<ParsedRow>().swap(result.rows);
+    }
+
+    vector<BatchReject> rejects = queue.tryInsertBatch(batch);
+    for (const BatchReject& reject : rejects) {
+        report.errors.push_back({batchLines[reject.index], employeeErrorMessage(reject.error)});
+    }
+    report.rowsImported = batch.size() - rejects.size();
+
+    sort(report.errors.begin(), report.errors.end(),
+        [](const ImportError& a, const ImportError& b) {
+            return a.line < b.line;
+        });
+
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,59 @@
+#ifndef EMPLOYEE_IMPORT_H
+#define EMPLOYEE_IMPORT_H
+
+#include "employee_management.h"
+#include "employee_pool.h"
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// read only memory mapping of a whole file, unmapped when it goes out of scope
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const string& path); // throws runtime_error if the file can't be opened/mapped
+    ~MappedFile();
+
+    string_view contents() const { return string_view(data, length); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+struct ImportError {
+    size_t line; // 1 based line in the file
+    string message;
+};
+
+struct ImportReport {
+    size_t rowsRead = 0;     // data rows seen, header and blank lines not counted
+    size_t rowsImported = 0; // rows that made it into the queue
+    double seconds = 0.0;
+    vector<ImportError> errors;
+
+    double rowsPerSecond() const { return seconds > 0.0 ? rowsRead / seconds : 0.0; }
+};
+
+struct ImportOptions {
+    char delimiter = 0;  // 0 = pick ',' or '\t' from the first line
+    size_t threads = 0;  // 0 = one per core
+};
+
+// roster files are CSV or TSV with one employee per line:
+//   id,name,class,experience,level,technology
+// class is CIO/PM/BD/FD/DB/DE/TST, level JUNIOR/MIDDLE/SENIOR (left empty for CIO/PM),
+// technology NET/SPRING/DJANGO for BD and ANGULAR/REACT/VUE for FD (empty for everyone else).
+// a first line starting with "id" is treated as a header. names may be "quoted" to hold the delimiter, "" inside quotes is a quote.
+// a 7th salary column (exportQueue's CSV has one) is allowed and ignored, salaries are always recomputed
+//
+// the file is memory mapped and split into chunks at line breaks, each chunk is parsed on its own thread.
+// good rows are built in the pool and added to the queue in one batch. nothing throws for bad rows,
+// they end up in the report (only failing to open/map the file throws)
+ImportReport importRoster(const string& path, EmployeePriorityQueue& queue, EmployeePool& pool,
+                          const ImportOptions& options = ImportOptions());
+
+#endif
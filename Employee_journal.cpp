@@ -0,0 +1,344 @@
+#include "employee_journal.h"
+#include "employee_import.h"
+#include "employee_snapshot.h"
+using namespace std;
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace {
+
+const char JournalMagic[8] = {'E', 'M', 'P', 'Q', 'J', 'R', 'N', 'L'};
+const uint32_t JournalVersion = 2; // 2 added OP_UPDATE
+const size_t JournalHeaderSize = 16;
+
+enum JournalOp : uint8_t {
+    OP_INSERT = 1,
+    OP_REMOVE = 2,
+    OP_UPDATE = 3 // same body as OP_INSERT
+};
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+// plain IEEE crc32
+uint32_t crc32(const char* data, size_t length) {
+    static const Crc32Table crcTable; //built once, thread safe since C++11
+    const uint32_t* table = crcTable.entries;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+template<class T>
+void put(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// reads a T if there's room, moves pos past it
+template<class T>
+bool take(string_view in, size_t& pos, T& value) {
+    if (in.size() - pos < sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+void writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue; //a signal, nothing was written
+            }
+            throw runtime_error(string("journal write failed: ") + strerror(errno));
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+// a record is only durable once this returns
+void syncData(int fd) {
+    while (fdatasync(fd) != 0) {
+        if (errno != EINTR) {
+            throw runtime_error(string("journal fsync failed: ") + strerror(errno));
+        }
+    }
+}
+
+} // namespace
+
+
+EmployeeJournal::EmployeeJournal(const string& path, GroupCommitPolicy policy) : policy(policy) {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throw runtime_error("can't open journal " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size == 0) {
+        char header[JournalHeaderSize] = {};
+        memcpy(header, JournalMagic, sizeof(JournalMagic));
+        memcpy(header + 8, &JournalVersion, sizeof(JournalVersion));
+        try {
+            writeAll(fd, header, sizeof(header));
+            syncData(fd);
+        }
+        catch (...) {
+            close(fd);
+            throw;
+        }
+    }
+    if (policy.everyMs > 0) {
+        flusher = thread(&EmployeeJournal::flusherLoop, this);
+    }
+}
+
+EmployeeJournal::~EmployeeJournal() {
+    {
+        lock_guard<mutex> guard(bufferMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    try {
+        sync();
+    }
+    catch (const exception&) {
+        //nothing sensible to do about a failed write in a destructor
+    }
+    close(fd);
+}
+
+void EmployeeJournal::append(const string& body) {
+    string record;
+    record.reserve(8 + body.size());
+    put<uint32_t>(record, static_cast<uint32_t>(body.size()));
+    put<uint32_t>(record, crc32(body.data(), body.size()));
+    record += body;
+
+    unique_lock<mutex> bufferLock(bufferMutex);
+    pending += record;
+    pendingOps++;
+    if (policy.everyOps > 0 && pendingOps >= policy.everyOps) {
+        flush(bufferLock);
+    }
+}
+
+// called with bufferMutex held, returns with it held again. the io lock is taken before the buffer lock
+// is dropped so groups hit the disk in order, and new records can be buffered while this one is synced
+void EmployeeJournal::flush(unique_lock<mutex>& bufferLock) {
+    if (failed) {
+        pending.clear(); //can't be made durable any more, don't let it pile up
+        pendingOps = 0;
+        throw runtime_error("journal failed earlier, later records can't be made durable");
+    }
+    if (pending.empty()) {
+        return;
+    }
+    string group;
+    group.swap(pending);
+    pendingOps = 0;
+    exception_ptr error;
+    {
+        lock_guard<mutex> ioLock(ioMutex);
+        bufferLock.unlock();
+        try {
+            writeAll(fd, group.data(), group.size());
+            syncData(fd);
+        }
+        catch (...) {
+            //after a failed fsync the kernel may have dropped the dirty pages, so retrying could report
+            //records as durable that never reached the disk. every later flush fails instead
+            failed = true;
+            error = current_exception(); //rethrown below, the buffer lock can't be retaken while we hold io
+        }
+    }
+    bufferLock.lock(); //only after the io lock is gone, sync() and append() take them the other way round
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+void EmployeeJournal::flusherLoop() {
+    unique_lock<mutex> bufferLock(bufferMutex);
+    while (!stopping) {
+        wake.wait_for(bufferLock, chrono::milliseconds(policy.everyMs));
+        try {
+            flush(bufferLock);
+        }
+        catch (const exception&) {
+            //failed is latched, so the caller's next sync() or append throws. the thread just carries on
+        }
+    }
+}
+
+void EmployeeJournal::sync() {
+    unique_lock<mutex> bufferLock(bufferMutex);
+    flush(bufferLock);
+}
+
+void EmployeeJournal::appendEmployee(uint8_t op, const Employee& employee) {
+    EmployeeSpec spec = employee.describe();
+    string body;
+    body.reserve(20 + spec.name.size());
+    put<uint8_t>(body, op);
+    put<int32_t>(body, spec.id);
+    put<int32_t>(body, spec.experience);
+    put<uint8_t>(body, static_cast<uint8_t>(spec.eClass));
+    put<uint8_t>(body, static_cast<uint8_t>(spec.level));
+    put<uint8_t>(body, spec.technology);
+    put<uint32_t>(body, static_cast<uint32_t>(spec.name.size()));
+    body.append(spec.name);
+    append(body);
+}
+
+void EmployeeJournal::employeeInserted(const Employee& employee) {
+    appendEmployee(OP_INSERT, employee);
+}
+
+void EmployeeJournal::employeeUpdated(const Employee& employee) {
+    appendEmployee(OP_UPDATE, employee);
+}
+
+void EmployeeJournal::employeeRemoved(int employeeId) {
+    string body;
+    put<uint8_t>(body, OP_REMOVE);
+    put<int32_t>(body, employeeId);
+    append(body);
+}
+
+// snapshot first, then drop the journal back to just its header. save() has the snapshot fsynced (file and
+// directory) before it returns, so the truncate can't reach the disk ahead of it. a crash in between just
+// means the old records get replayed over a snapshot that already has them, which replay handles
+void EmployeeJournal::compact(const EmployeePriorityQueue& queue, const string& snapshotPath) {
+    sync();
+    queue.save(snapshotPath);
+
+    lock_guard<mutex> ioLock(ioMutex);
+    try {
+        if (ftruncate(fd, JournalHeaderSize) != 0) {
+            throw runtime_error("can't truncate journal");
+        }
+        syncData(fd);
+    }
+    catch (...) {
+        failed = true; //the file is in an unknown state, appending to it would be worse than stopping
+        throw;
+    }
+}
+
+size_t EmployeeJournal::replay(const string& path, EmployeePriorityQueue& queue, EmployeePool& pool) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || info.st_size == 0) {
+        return 0; //no journal yet
+    }
+
+    size_t applied = 0;
+    size_t goodLength = 0;
+    {
+        MappedFile file(path);
+        string_view data = file.contents();
+        if (data.size() < JournalHeaderSize || memcmp(data.data(), JournalMagic, sizeof(JournalMagic)) != 0) {
+            throw runtime_error(path + " is not an employee journal");
+        }
+        uint32_t version = 0;
+        memcpy(&version, data.data() + 8, sizeof(version));
+        if (version > JournalVersion) {
+            throw runtime_error(path + " was written by a newer version");
+        }
+
+        size_t pos = JournalHeaderSize;
+        goodLength = pos;
+        while (pos < data.size()) {
+            uint32_t length = 0;
+            uint32_t checksum = 0;
+            if (!take(data, pos, length) || !take(data, pos, checksum) || data.size() - pos < length ||
+                crc32(data.data() + pos, length) != checksum) {
+                break; //torn write at the end
+            }
+            string_view body = data.substr(pos, length);
+            pos += length;
+
+            size_t at = 0;
+            uint8_t op = 0;
+            int32_t id = 0;
+            if (!take(body, at, op) || !take(body, at, id)) {
+                break;
+            }
+            if (op == OP_INSERT || op == OP_UPDATE) {
+                EmployeeSpec spec;
+                int32_t experience = 0;
+                uint8_t eClass = 0, level = 0, technology = 0;
+                uint32_t nameLength = 0;
+                if (!take(body, at, experience) || !take(body, at, eClass) || !take(body, at, level) ||
+                    !take(body, at, technology) || !take(body, at, nameLength) || body.size() - at < nameLength) {
+                    break;
+                }
+                spec.id = id;
+                spec.experience = experience;
+                spec.eClass = static_cast<EmployeeClass>(eClass);
+                spec.level = static_cast<QualificationLevel>(level);
+                spec.technology = technology;
+                spec.name = body.substr(at, nameLength);
+                if (op == OP_UPDATE && queue.contains(id)) {
+                    queue.remove(id); //replaced by the record's version below
+                }
+                if (!queue.contains(id)) {
+                    EmployeeResult created = pool.tryCreate(spec);
+                    if (created) {
+                        queue.tryInsert(move(created.employee));
+                    }
+                }
+            } else if (op == OP_REMOVE) {
+                if (queue.contains(id)) {
+                    queue.remove(id);
+                }
+            } else {
+                break;
+            }
+            applied++;
+            goodLength = pos;
+        }
+    }
+
+    if (goodLength < static_cast<size_t>(info.st_size) &&
+        truncate(path.c_str(), static_cast<off_t>(goodLength)) != 0) { //new records must not land after garbage
+        throw runtime_error("can't cut the torn tail off " + path + ": " + strerror(errno));
+    }
+    return applied;
+}
+
+size_t EmployeeJournal::recover(const string& snapshotPath, const string& journalPath,
+                                EmployeePriorityQueue& queue, EmployeePool& pool) {
+    struct stat info;
+    if (stat(snapshotPath.c_str(), &info) == 0) {
+        EmployeeSnapshot(snapshotPath).restore(queue, pool);
+    }
+    return replay(journalPath, queue, pool);
+}
@@ -0,0 +1,76 @@
+#ifndef EMPLOYEE_JOURNAL_H
+#define EMPLOYEE_JOURNAL_H
+
+#include "employee_management.h"
+#include "employee_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+using namespace std;
+
+// when buffered journal records get written and fsynced
+struct GroupCommitPolicy {
+    size_t everyOps = 128; // as soon as this many records are waiting (0 = no count trigger)
+    unsigned everyMs = 10; // and at least this often while anything is waiting (0 = no background flusher)
+};
+
+// append only write ahead journal of queue changes. attach it with queue.setListener(&journal)
+//
+// file: 16 byte header, then records of [u32 body length][u32 crc32 of body][body]
+// body: u8 op, i32 id, and for inserts/updates i32 experience, u8 class, u8 level, u8 technology, u32 name length, name
+// extractMax is journaled as a removal of the id that came out, so replay doesn't depend on how ties break
+//
+// records are buffered and fsynced in groups (see GroupCommitPolicy). a crash loses at most the last group.
+// once a write or fsync fails the journal stays failed: sync() and appends that trigger a flush throw
+// runtime_error from then on, since nothing written after that point can be trusted to be on disk
+class EmployeeJournal : public QueueListener {
+private:
+    int fd = -1;
+    GroupCommitPolicy policy;
+
+    mutex bufferMutex; // guards pending, pendingOps, stopping
+    mutex ioMutex;     // keeps writes in order while appends carry on
+    condition_variable wake;
+    string pending;
+    size_t pendingOps = 0;
+    bool stopping = false;
+    atomic<bool> failed{false}; // a write or fsync failed. latched, every later sync/flush throws
+    thread flusher;
+
+    void append(const string& body);
+    void appendEmployee(uint8_t op, const Employee& employee);
+    void flush(unique_lock<mutex>& bufferLock); // takes the buffer, writes and syncs it
+    void flusherLoop();
+
+public:
+    explicit EmployeeJournal(const string& path, GroupCommitPolicy policy = GroupCommitPolicy());
+    ~EmployeeJournal(); // syncs whatever is still buffered
+
+    // QueueListener
+    void employeeInserted(const Employee& employee) override;
+    void employeeRemoved(int employeeId) override;
+    void employeeUpdated(const Employee& employee) override;
+
+    void sync(); // write and fsync everything buffered so far. throws runtime_error if that, or anything before it, failed
+
+    // fold the journal into a snapshot: save the queue, then start the journal over empty
+    void compact(const EmployeePriorityQueue& queue, const string& snapshotPath);
+
+    // apply a journal to a queue, returns how many records were applied. a torn or corrupt tail
+    // (crash mid write) is cut off the file. replaying on top of a snapshot that already has some of the
+    // changes is fine: every id ends up as its last record says, so compaction doesn't need two phases
+    static size_t replay(const string& path, EmployeePriorityQueue& queue, EmployeePool& pool);
+
+    // startup: load the snapshot if there is one, then replay the journal over it.
+    // do this before attaching the journal, or the replay gets journaled again
+    static size_t recover(const string& snapshotPath, const string& journalPath,
+                          EmployeePriorityQueue& queue, EmployeePool& pool);
+
+    EmployeeJournal(const EmployeeJournal&) = delete;
+    EmployeeJournal& operator=(const EmployeeJournal&) = delete;
+};
+
+#endif
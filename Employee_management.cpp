@@ -1,91 +1,298 @@
 #include "employee_management.h"
+#include "employee_names.h"
+#include "employee_metrics.h"
+#include "employee_versions.h"
 using namespace std;
 
 #include <algorithm>
 #include <stdexcept>
 #include <iomanip>
+#include <cmath>
+#include <thread>
 
 
 // base Employee class
-Employee::Employee(const string& name, int id, EmployeeClass eClass, int experience)
-    : name(name), employeeId(id), employeeClass(eClass), salary(0.0), experienceMonths(experience) {
+Employee::Employee(string_view name, int id, EmployeeClass eClass, int experience)
+    : employeeId(id), employeeClass(eClass), salary(0.0), experienceMonths(experience) {
     //invalid input handling
+    EmployeeError error = checkEmployeeFields(name, id, experience);
+    if (error != EmployeeError::NONE) {
+        throw invalid_argument(employeeErrorMessage(error));
+    }
+    this->name = employeeNames().intern(name); //only names that made it past the checks take up arena space
+}
+
+// validation, shared by the throwing constructors and the error code path
+const char* employeeErrorMessage(EmployeeError error) {
+    switch (error) {
+        case EmployeeError::NONE: return "no error";
+        case EmployeeError::EMPTY_NAME: return "Employee name cant be empty";
+        case EmployeeError::INVALID_ID: return "Employee id cant be negative";
+        case EmployeeError::NEGATIVE_EXPERIENCE: return "experience cannot be negative";
+        case EmployeeError::UNKNOWN_CLASS: return "unknown employee class";
+        case EmployeeError::UNKNOWN_LEVEL: return "unknown qualification level";
+        case EmployeeError::UNKNOWN_TECHNOLOGY: return "unknown technology";
+        case EmployeeError::NULL_EMPLOYEE: return "can't insert null employee";
+        case EmployeeError::DUPLICATE_ID: return "employee with this ID already exists";
+    }
+    return "unknown error";
+}
+
+EmployeeError checkEmployeeFields(string_view name, int id, int experience) {
     if (name.empty()) {
-        throw invalid_argument("Employee name cant be empty");
+        return EmployeeError::EMPTY_NAME;
     }
     if (id <= 0) {
-        throw invalid_argument("Employee id cant be negative");
+        return EmployeeError::INVALID_ID;
     }
     if (experience < 0) {
-        throw invalid_argument("experience cannot be negative");
+        return EmployeeError::NEGATIVE_EXPERIENCE;
     }
+    return EmployeeError::NONE;
+}
+
+EmployeeError validateEmployee(const EmployeeSpec& spec) {
+    if (spec.name.empty()) {
+        return EmployeeError::EMPTY_NAME;
+    }
+    if (spec.id <= 0) {
+        return EmployeeError::INVALID_ID;
+    }
+    if (spec.experience < 0) {
+        return EmployeeError::NEGATIVE_EXPERIENCE;
+    }
+    if (static_cast<size_t>(spec.eClass) >= EmployeeClassCount) {
+        return EmployeeError::UNKNOWN_CLASS;
+    }
+    if (static_cast<size_t>(spec.level) >= QualificationLevelCount) {
+        return EmployeeError::UNKNOWN_LEVEL;
+    }
+    if (spec.technology >= TechnologyCount) {
+        return EmployeeError::UNKNOWN_TECHNOLOGY;
+    }
+    return EmployeeError::NONE;
+}
+
+void Employee::setExperience(int months) {
+    if (months < 0) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::NEGATIVE_EXPERIENCE));
+    }
+    experienceMonths = months;
+    salary = calculateSalary();
+}
+
+EmployeeSpec Employee::describe() const {
+    EmployeeSpec spec;
+    spec.name = name;
+    spec.id = employeeId;
+    spec.eClass = employeeClass;
+    spec.experience = experienceMonths;
+    return spec;
 }
 
 // qualified employees' base class, which is a child/derivation of Employee
-QualifiedEmployee::QualifiedEmployee(const string& name, int id, EmployeeClass eClass, 
+QualifiedEmployee::QualifiedEmployee(string_view name, int id, EmployeeClass eClass, 
                                    int experience, QualificationLevel level)
-    : Employee(name, id, eClass, experience), qualificationLevel(level) {}
+    : Employee(name, id, eClass, experience), qualificationLevel(level) {
+    //the level indexes the rate tables and the queue's indexes, so it has to be one of the three
+    if (static_cast<size_t>(level) >= QualificationLevelCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_LEVEL));
+    }
+}
+
+void QualifiedEmployee::setQualificationLevel(QualificationLevel level) {
+    if (static_cast<size_t>(level) >= QualificationLevelCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_LEVEL));
+    }
+    qualificationLevel = level;
+    salary = calculateSalary();
+}
+
+EmployeeSpec QualifiedEmployee::describe() const {
+    EmployeeSpec spec = Employee::describe();
+    spec.level = qualificationLevel;
+    return spec;
+}
+
+// enum names, same spelling as the enums themselves
+static const char* const employeeClassNames[EmployeeClassCount] = {"CIO", "PM", "BD", "FD", "DB", "DE", "TST"};
+static const char* const qualificationLevelNames[QualificationLevelCount] = {"JUNIOR", "MIDDLE", "SENIOR"};
+static const char* const backendTechnologyNames[TechnologyCount] = {"NET", "SPRING", "DJANGO"};
+static const char* const frontendTechnologyNames[TechnologyCount] = {"ANGULAR", "REACT", "VUE"};
+
+const char* employeeClassName(EmployeeClass eClass) {
+    size_t index = static_cast<size_t>(eClass);
+    return index < EmployeeClassCount ? employeeClassNames[index] : "?";
+}
+
+const char* qualificationLevelName(QualificationLevel level) {
+    size_t index = static_cast<size_t>(level);
+    return index < QualificationLevelCount ? qualificationLevelNames[index] : "?";
+}
+
+const char* technologyName(EmployeeClass eClass, uint8_t technology) {
+    if (technology >= TechnologyCount) {
+        return "?";
+    }
+    if (eClass == EmployeeClass::BD) {
+        return backendTechnologyNames[technology];
+    }
+    if (eClass == EmployeeClass::FD) {
+        return frontendTechnologyNames[technology];
+    }
+    return "";
+}
+
+// linear search is fine, there are at most 7 names
+template<size_t N>
+static bool parseName(const char* const (&names)[N], string_view text, size_t& out) {
+    for (size_t i = 0; i < N; i++) {
+        if (text == names[i]) {
+            out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseEmployeeClass(string_view text, EmployeeClass& out) {
+    size_t index;
+    if (!parseName(employeeClassNames, text, index)) {
+        return false;
+    }
+    out = static_cast<EmployeeClass>(index);
+    return true;
+}
+
+bool parseQualificationLevel(string_view text, QualificationLevel& out) {
+    size_t index;
+    if (!parseName(qualificationLevelNames, text, index)) {
+        return false;
+    }
+    out = static_cast<QualificationLevel>(index);
+    return true;
+}
+
+bool parseTechnology(EmployeeClass eClass, string_view text, uint8_t& out) {
+    size_t index;
+    if (eClass == EmployeeClass::BD && parseName(backendTechnologyNames, text, index)) {
+        out = static_cast<uint8_t>(index);
+        return true;
+    }
+    if (eClass == EmployeeClass::FD && parseName(frontendTechnologyNames, text, index)) {
+        out = static_cast<uint8_t>(index);
+        return true;
+    }
+    return false;
+}
 
 // helper functions for salary calculator function
 
+static SalaryPolicy activePolicy = DefaultSalaryPolicy;
+
+const SalaryPolicy& salaryPolicy() {
+    return activePolicy;
+}
+
+bool validSalaryRate(double rate) {
+    return rate > 0.0 && rate < HUGE_VAL; //false for nan too
+}
+
+bool validExperienceBonus(double perYear) {
+    return perYear >= 0.0 && perYear < HUGE_VAL;
+}
+
+void setSalaryPolicy(const SalaryPolicy& policy) {
+    bool ok = all_of(policy.baseSalary.begin(), policy.baseSalary.end(), validSalaryRate) &&
+              all_of(policy.qualificationMultiplier.begin(), policy.qualificationMultiplier.end(), validSalaryRate) &&
+              all_of(policy.backendTechBonus.begin(), policy.backendTechBonus.end(), validSalaryRate) &&
+              all_of(policy.frontendTechBonus.begin(), policy.frontendTechBonus.end(), validSalaryRate) &&
+              validExperienceBonus(policy.experienceBonusPerYear);
+    if (!ok) {
+        throw invalid_argument("salary rates must be positive and finite");
+    }
+    activePolicy = policy;
+}
+
+// table lookups, out of range values get the same fallback the old switches had
+double getBaseSalary(EmployeeClass eClass) {
+    size_t index = static_cast<size_t>(eClass);
+    return index < EmployeeClassCount ? activePolicy.baseSalary[index] : 0.0;
+}
+
     double getQualificationMultiplier(QualificationLevel level) {
-        switch (level) {
-            case QualificationLevel::JUNIOR: return 1.0;
-            case QualificationLevel::MIDDLE: return 1.50;
-            case QualificationLevel::SENIOR: return 2.0;
-            default: return 1.0;
-        }
+        size_t index = static_cast<size_t>(level);
+        return index < QualificationLevelCount ? activePolicy.qualificationMultiplier[index] : 1.0;
     }
 
     double getExperienceBonus(int months) {
-        return 1.0 + (months / 12.0) * 0.10; // 10% bonus a year
+        return 1.0 + (months / 12.0) * activePolicy.experienceBonusPerYear;
     }
 
+// bonuses are offered based on which tech skills u have
+double getBackendTechBonus(BackendTechnology tech) {
+    size_t index = static_cast<size_t>(tech);
+    return index < TechnologyCount ? activePolicy.backendTechBonus[index] : 1.0;
+}
+
+double getFrontendTechBonus(FrontendTechnology tech) {
+    size_t index = static_cast<size_t>(tech);
+    return index < TechnologyCount ? activePolicy.frontendTechBonus[index] : 1.0;
+}
 
 //specific employee types, starting business
 
 //CIO just uses Employee constructor, and I manually enter CIO for eclass -- enums turned out to be just extra work..
-CIO::CIO(const string& name, int id, int experience)
+CIO::CIO(string_view name, int id, int experience)
     : Employee(name, id, EmployeeClass::CIO, experience) {
     salary = calculateSalary();
 }
 
-// hardcoded common salaries into each override
 double CIO::calculateSalary() {
-    const double baseSalary = 15000.0;
+    const double baseSalary = getBaseSalary(EmployeeClass::CIO);
     return baseSalary * getExperienceBonus(getExperience()); //getExperience() gives months
 }
 
 // PM is also only a child of employee
-ProjectManager::ProjectManager(const string& name, int id, int experience)
+ProjectManager::ProjectManager(string_view name, int id, int experience)
     : Employee(name, id, EmployeeClass::PM, experience) {
     salary = calculateSalary();
 }
 
 double ProjectManager::calculateSalary() {
-    const double baseSalary = 10000.0;
+    const double baseSalary = getBaseSalary(EmployeeClass::PM);
     return baseSalary * getExperienceBonus(getExperience());
 }
 
 //developers
 //children of both QualifiedEmployee and EMployee
 
-BackendDeveloper::BackendDeveloper(const string& name, int id, int experience,
+BackendDeveloper::BackendDeveloper(string_view name, int id, int experience,
                                  QualificationLevel level, BackendTechnology tech)
     : QualifiedEmployee(name, id, EmployeeClass::BD, experience, level), technology(tech) {
+    if (static_cast<size_t>(tech) >= TechnologyCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY));
+    }
     salary = calculateSalary();
 }
 
-double BackendDeveloper::calculateSalary() {
-    const double baseSalary = 7000.0;
-    double techBonus = 1.0;
-    
-    // bonuses are offered based on which tech skills u have
-    switch (technology) {
-        case BackendTechnology::NET: techBonus = 1.15; break;
-        case BackendTechnology::SPRING: techBonus = 1.10; break;
-        case BackendTechnology::DJANGO: techBonus = 1.05; break;
+void BackendDeveloper::setTechnology(BackendTechnology tech) {
+    if (static_cast<size_t>(tech) >= TechnologyCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY));
     }
+    technology = tech;
+    salary = calculateSalary();
+}
+
+EmployeeSpec BackendDeveloper::describe() const {
+    EmployeeSpec spec = QualifiedEmployee::describe();
+    spec.technology = static_cast<uint8_t>(technology);
+    return spec;
+}
+
+double BackendDeveloper::calculateSalary() {
+    const double baseSalary = getBaseSalary(EmployeeClass::BD);
+    double techBonus = getBackendTechBonus(technology);
     //final salary calculation
     return baseSalary * 
            getQualificationMultiplier(qualificationLevel) * 
@@ -94,22 +301,32 @@ double BackendDeveloper::calculateSalary() {
 }
 
 
-FrontendDeveloper::FrontendDeveloper(const string& name, int id, int experience,
+FrontendDeveloper::FrontendDeveloper(string_view name, int id, int experience,
                                    QualificationLevel level, FrontendTechnology tech)
     : QualifiedEmployee(name, id, EmployeeClass::FD, experience, level), technology(tech) {
+    if (static_cast<size_t>(tech) >= TechnologyCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY));
+    }
     salary = calculateSalary();
 }
 
-double FrontendDeveloper::calculateSalary() {
-    const double baseSalary = 6500.0; //frontend < backend 0o0
-    double techBonus = 1.0;
-    
-    //bonuses are offered based on which tech skills u have
-    switch (technology) {
-        case FrontendTechnology::REACT: techBonus = 1.15; break;
-        case FrontendTechnology::ANGULAR: techBonus = 1.10; break;
-        case FrontendTechnology::VUE: techBonus = 1.05; break;
+void FrontendDeveloper::setTechnology(FrontendTechnology tech) {
+    if (static_cast<size_t>(tech) >= TechnologyCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_TECHNOLOGY));
     }
+    technology = tech;
+    salary = calculateSalary();
+}
+
+EmployeeSpec FrontendDeveloper::describe() const {
+    EmployeeSpec spec = QualifiedEmployee::describe();
+    spec.technology = static_cast<uint8_t>(technology);
+    return spec;
+}
+
+double FrontendDeveloper::calculateSalary() {
+    const double baseSalary = getBaseSalary(EmployeeClass::FD);
+    double techBonus = getFrontendTechBonus(technology);
     
     return baseSalary * 
            getQualificationMultiplier(qualificationLevel) * 
@@ -119,149 +336,1088 @@ double FrontendDeveloper::calculateSalary() {
 
 
 // engineers, similar to devs, except no tech skill bonuses
-DatabaseEngineer::DatabaseEngineer(const string& name, int id, int experience,
+DatabaseEngineer::DatabaseEngineer(string_view name, int id, int experience,
                                  QualificationLevel level)
     : QualifiedEmployee(name, id, EmployeeClass::DB, experience, level) {
     salary = calculateSalary();
 }
 
 double DatabaseEngineer::calculateSalary() {
-    const double baseSalary = 8000.0;
+    const double baseSalary = getBaseSalary(EmployeeClass::DB);
     return baseSalary * 
            getQualificationMultiplier(qualificationLevel) * 
            getExperienceBonus(getExperience());
 }
 
 
-DevOpsEngineer::DevOpsEngineer(const string& name, int id, int experience,
+DevOpsEngineer::DevOpsEngineer(string_view name, int id, int experience,
                               QualificationLevel level)
     : QualifiedEmployee(name, id, EmployeeClass::DE, experience, level) {
     salary = calculateSalary();
 }
 
 double DevOpsEngineer::calculateSalary() {
-    const double baseSalary = 7500.0;
+    const double baseSalary = getBaseSalary(EmployeeClass::DE);
     return baseSalary * 
            getQualificationMultiplier(qualificationLevel) * 
            getExperienceBonus(getExperience());
 }
 
 
-Tester::Tester(const string& name, int id, int experience,
+Tester::Tester(string_view name, int id, int experience,
                QualificationLevel level)
     : QualifiedEmployee(name, id, EmployeeClass::TST, experience, level) {
     salary = calculateSalary();
 }
 
 double Tester::calculateSalary() {
-    const double baseSalary = 5500.0;
+    const double baseSalary = getBaseSalary(EmployeeClass::TST);
     return baseSalary * 
            getQualificationMultiplier(qualificationLevel) * 
            getExperienceBonus(getExperience());
 }
 
 
+// id -> slot map used by the queue
+uint32_t IdSlotMap::find(int id) const {
+    if (buckets.empty()) {
+        return npos;
+    }
+    for (size_t i = home(id);; i = (i + 1) & (buckets.size() - 1)) {
+        if (buckets[i].id == id) {
+            return buckets[i].slot;
+        }
+        if (buckets[i].id == 0) {
+            return npos;
+        }
+    }
+}
+
+void IdSlotMap::insert(int id, uint32_t slot) {
+    if ((count + 1) * 2 > buckets.size()) { //keep it at most half full so probes stay short
+        grow();
+    }
+    size_t i = home(id);
+    while (buckets[i].id != 0) {
+        i = (i + 1) & (buckets.size() - 1);
+    }
+    buckets[i] = {id, slot};
+    count++;
+}
+
+// backward shift delete, so no tombstones pile up after lots of removals
+void IdSlotMap::erase(int id) {
+    if (buckets.empty()) {
+        return;
+    }
+    const size_t mask = buckets.size() - 1;
+    size_t hole = home(id);
+    while (buckets[hole].id != id) {
+        if (buckets[hole].id == 0) {
+            return; //not there
+        }
+        hole = (hole + 1) & mask;
+    }
+    size_t next = (hole + 1) & mask;
+    while (buckets[next].id != 0) {
+        // an entry can move back into the hole only if its home bucket isn't between the hole and itself
+        size_t want = home(buckets[next].id);
+        if (((next - want) & mask) >= ((next - hole) & mask)) {
+            buckets[hole] = buckets[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    buckets[hole] = {0, 0};
+    count--;
+}
+
+void IdSlotMap::reserve(size_t n) {
+    if (n * 2 <= buckets.size()) {
+        return;
+    }
+    size_t capacity = 16;
+    while (capacity < n * 2) {
+        capacity *= 2;
+    }
+    vector<Bucket> old;
+    old.swap(buckets);
+    buckets.assign(capacity, Bucket{0, 0});
+    count = 0;
+    for (const Bucket& b : old) {
+        if (b.id != 0) {
+            insert(b.id, b.slot);
+        }
+    }
+}
+
+void IdSlotMap::grow() {
+    reserve(buckets.empty() ? 8 : buckets.size());
+}
+
+void IdSlotMap::clear() {
+    buckets.clear();
+    count = 0;
+}
+
+
 // priority Queue
+EmployeePriorityQueue::EmployeePriorityQueue(size_t arity) : arity(arity) {
+    if (arity < 2) {
+        throw invalid_argument("heap arity must be at least 2");
+    }
+}
+
+EmployeePriorityQueue::EmployeePriorityQueue(vector<EmployeeHandle> employees, size_t arity)
+    : EmployeePriorityQueue(arity) {
+    insertBatch(move(employees));
+}
+
 EmployeePriorityQueue::~EmployeePriorityQueue() {
-    for (Employee* emp : employees) {
-        delete emp;
+    payload.clear(); //handles give every employee back to its pool (or delete it)
+    heap.clear();
+}
+
+// every write into the heap goes through here so slot -> position never goes stale
+void EmployeePriorityQueue::placeAt(size_t pos, const HeapEntry& entry) {
+    heap[pos] = entry;
+    heapPos[entry.slot] = pos;
+}
+
+// move an entry up while it earns more than its parent
+void EmployeePriorityQueue::siftUp(size_t pos) {
+    HeapEntry moving = heap[pos];
+    size_t levels = 0;
+    while (pos > 0) {
+        size_t parent = (pos - 1) / arity;
+        if (!(heap[parent].salary < moving.salary)) {
+            break;
+        }
+        placeAt(pos, heap[parent]);
+        pos = parent;
+        levels++;
+    }
+    placeAt(pos, moving);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SIFT_UP, 1);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SIFT_UP_LEVELS, levels);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::COMPARISONS, pos > 0 ? levels + 1 : levels); // the one that stopped it
+}
+
+// move an entry down while one of its children earns more
+void EmployeePriorityQueue::siftDown(size_t pos) {
+    const size_t count = heap.size();
+    HeapEntry moving = heap[pos];
+    size_t levels = 0;
+    size_t comparisons = 0;
+    while (true) {
+        size_t first = arity * pos + 1;
+        if (first >= count) {
+            break;
+        }
+        //pick the biggest child, siblings sit next to each other in memory
+        size_t last = min(first + arity, count);
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (heap[best].salary < heap[child].salary) {
+                best = child;
+            }
+        }
+        comparisons += last - first; // siblings against each other, then the best against the one moving
+        if (!(moving.salary < heap[best].salary)) {
+            break;
+        }
+        placeAt(pos, heap[best]);
+        pos = best;
+        levels++;
+    }
+    placeAt(pos, moving);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SIFT_DOWN, 1);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SIFT_DOWN_LEVELS, levels);
+    EMPLOYEE_METRICS_COUNT(QueueCounter::COMPARISONS, comparisons);
+}
+
+uint32_t EmployeePriorityQueue::acquireSlot(EmployeeHandle employee) {
+    int employeeId = employee->getEmployeeId();
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        payload[slot] = move(employee);
+    } else {
+        slot = static_cast<uint32_t>(payload.size());
+        payload.push_back(move(employee));
+        heapPos.push_back(0);
+        indexKeys.emplace_back();
+    }
+    slotOf.insert(employeeId, slot);
+    indexSlot(slot);
+    double salary = payload[slot]->getSalary();
+    countPayroll(slot, salary);
+    if (bySalaryBuilt) {
+        bySalary.insert(salary, employeeId);
+    }
+    if (versions) {
+        versions->set(slot, *payload[slot]);
+    }
+    return slot;
+}
+
+// the id comes from the caller (heap entry or remove's argument) so we don't touch the Employee object here.
+// the slot is still in the heap at this point, so the salary comes from its entry
+EmployeeHandle EmployeePriorityQueue::releaseSlot(uint32_t slot, int employeeId) {
+    EmployeeHandle employee = detachSlot(slot, employeeId);
+    freeSlots.push_back(slot);
+    return employee;
+}
+
+EmployeeHandle EmployeePriorityQueue::detachSlot(uint32_t slot, int employeeId) {
+    double salary = heap[heapPos[slot]].salary;
+    uncountPayroll(slot, salary);
+    unindexSlot(slot);
+    if (bySalaryBuilt) {
+        bySalary.erase(salary, employeeId);
+    }
+    if (versions) {
+        versions->clear(slot);
+    }
+    EmployeeHandle employee = move(payload[slot]);
+    slotOf.erase(employeeId);
+    return employee;
+}
+
+// take the entry at pos out of the heap: last entry fills the hole, then one sift fixes it
+void EmployeePriorityQueue::removeAt(size_t pos) {
+    HeapEntry last = heap.back();
+    heap.pop_back();
+    if (pos < heap.size()) {
+        heap[pos] = last;
+        if (pos > 0 && heap[(pos - 1) / arity].salary < last.salary) {
+            siftUp(pos);
+        } else {
+            siftDown(pos);
+        }
+    }
+}
+
+// add the employee in this slot to every posting list that applies to it
+void EmployeePriorityQueue::indexSlot(uint32_t slot) {
+    EmployeeSpec spec = payload[slot]->describe();
+    bool qualified = spec.eClass != EmployeeClass::CIO && spec.eClass != EmployeeClass::PM;
+
+    IndexKeys& keys = indexKeys[slot];
+    keys.value[BY_CLASS] = static_cast<uint8_t>(spec.eClass);
+    keys.value[BY_LEVEL] = qualified ? static_cast<uint8_t>(spec.level) : NotIndexed;
+    keys.value[BY_BACKEND] = spec.eClass == EmployeeClass::BD ? spec.technology : NotIndexed;
+    keys.value[BY_FRONTEND] = spec.eClass == EmployeeClass::FD ? spec.technology : NotIndexed;
+
+    for (size_t kind = 0; kind < IndexKindCount; kind++) {
+        if (keys.value[kind] != NotIndexed) {
+            vector<uint32_t>& list = postings[kind][keys.value[kind]];
+            keys.position[kind] = static_cast<uint32_t>(list.size());
+            list.push_back(slot);
+        }
+    }
+}
+
+void EmployeePriorityQueue::unindexSlot(uint32_t slot) {
+    const IndexKeys& keys = indexKeys[slot];
+    for (size_t kind = 0; kind < IndexKindCount; kind++) {
+        if (keys.value[kind] == NotIndexed) {
+            continue;
+        }
+        vector<uint32_t>& list = postings[kind][keys.value[kind]];
+        uint32_t moved = list.back(); //last entry fills the hole
+        list[keys.position[kind]] = moved;
+        indexKeys[moved].position[kind] = keys.position[kind];
+        list.pop_back();
+    }
+}
+
+size_t salaryHistogramBucket(double salary) {
+    if (!(salary > 0.0)) {
+        return 0;
+    }
+    return min(static_cast<size_t>(salary / SalaryHistogramWidth), SalaryHistogramBuckets - 1);
+}
+
+// the groups a slot belongs to come from its index keys, so indexSlot has to run before counting
+size_t EmployeePriorityQueue::payrollGroupsOf(uint32_t slot, size_t groups[3]) const {
+    const IndexKeys& keys = indexKeys[slot];
+    size_t count = 0;
+    groups[count++] = PayrollAll;
+    groups[count++] = PayrollClassBase + static_cast<size_t>(keys.value[BY_CLASS]);
+    if (keys.value[BY_LEVEL] != NotIndexed) {
+        groups[count++] = PayrollLevelBase + static_cast<size_t>(keys.value[BY_LEVEL]);
+    }
+    return count;
+}
+
+void EmployeePriorityQueue::countPayroll(uint32_t slot, double salary) {
+    size_t groups[3];
+    size_t groupCount = payrollGroupsOf(slot, groups);
+    size_t bucket = salaryHistogramBucket(salary);
+    for (size_t i = 0; i < groupCount; i++) {
+        size_t group = groups[i];
+        PayrollAggregate& total = payrollGroups[group];
+        if (total.headcount == 0) {
+            total.minSalary = total.maxSalary = salary;
+            payrollExtremesStale[group] = false;
+        } else {
+            total.minSalary = min(total.minSalary, salary);
+            total.maxSalary = max(total.maxSalary, salary);
+        }
+        total.headcount++;
+        total.totalSalary += salary;
+        total.histogram[bucket]++;
+    }
+}
+
+void EmployeePriorityQueue::uncountPayroll(uint32_t slot, double salary) {
+    size_t groups[3];
+    size_t groupCount = payrollGroupsOf(slot, groups);
+    size_t bucket = salaryHistogramBucket(salary);
+    for (size_t i = 0; i < groupCount; i++) {
+        size_t group = groups[i];
+        PayrollAggregate& total = payrollGroups[group];
+        total.headcount--;
+        total.histogram[bucket]--;
+        if (total.headcount == 0) {
+            total = PayrollAggregate(); //also drops the rounding error the sum picked up
+            payrollExtremesStale[group] = false;
+            continue;
+        }
+        total.totalSalary -= salary;
+        if (salary == total.minSalary || salary == total.maxSalary) {
+            payrollExtremesStale[group] = true;
+        }
+    }
+}
+
+// rescans min/max if the last removal took one of them. everyone: the salary index has both ends if it
+// has been built, otherwise the heap top is the max and a pass over the heap finds the min.
+// a class or level: walk its posting list (the slot being dropped is already out of it)
+const PayrollAggregate& EmployeePriorityQueue::payrollGroup(size_t group) const {
+    PayrollAggregate& total = payrollGroups[group];
+    if (!payrollExtremesStale[group]) {
+        return total;
+    }
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SCAN_PAYROLL_MINMAX, 1);
+    if (group == PayrollAll && bySalaryBuilt) {
+        total.minSalary = bySalary.select(0).first;
+        total.maxSalary = bySalary.select(bySalary.size() - 1).first;
+    } else if (group == PayrollAll) {
+        total.minSalary = total.maxSalary = heap.front().salary;
+        for (const HeapEntry& entry : heap) {
+            if (!isTombstone(entry)) {
+                total.minSalary = min(total.minSalary, entry.salary);
+            }
+        }
+    } else {
+        const vector<uint32_t>& slots = group < PayrollLevelBase
+            ? postings[BY_CLASS][group - PayrollClassBase]
+            : postings[BY_LEVEL][group - PayrollLevelBase];
+        total.minSalary = total.maxSalary = heap[heapPos[slots.front()]].salary;
+        for (uint32_t slot : slots) {
+            double salary = heap[heapPos[slot]].salary;
+            total.minSalary = min(total.minSalary, salary);
+            total.maxSalary = max(total.maxSalary, salary);
+        }
+    }
+    payrollExtremesStale[group] = false;
+    return total;
+}
+
+PayrollAggregate EmployeePriorityQueue::payrollByClass(EmployeeClass eClass) const {
+    size_t index = static_cast<size_t>(eClass);
+    if (index >= EmployeeClassCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_CLASS));
+    }
+    return payrollGroup(PayrollClassBase + index);
+}
+
+PayrollAggregate EmployeePriorityQueue::payrollByLevel(QualificationLevel level) const {
+    size_t index = static_cast<size_t>(level);
+    if (index >= QualificationLevelCount) {
+        throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_LEVEL));
     }
-    employees.clear(); //fully clear the queue
+    return payrollGroup(PayrollLevelBase + index);
+}
+
+// sift down every parent, last one first. cheaper than n inserts (O(n) instead of O(n log n))
+void EmployeePriorityQueue::heapify() {
+    if (heap.size() < 2) {
+        return;
+    }
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SCAN_HEAPIFY, 1);
+    for (size_t pos = (heap.size() - 2) / arity + 1; pos-- > 0;) {
+        siftDown(pos);
+    }
+}
+
+// nulls, ids already in the queue and ids repeated inside the batch are all rejected
+// ids are claimed in slotOf while checking, so each one costs a single hash probe. a throwing failure rolls them back
+void EmployeePriorityQueue::appendBatch(vector<EmployeeHandle>& batch, vector<BatchReject>* rejects) {
+    EMPLOYEE_METRICS_TIME(QueueOp::INSERT_BATCH);
+    const size_t freeCount = freeSlots.size();
+    const size_t firstNewSlot = payload.size();
+    const size_t reused = min(freeCount, batch.size());
+    // the k-th accepted employee gets a free slot first, then new slots at the end of the payload
+    auto slotFor = [&](size_t k) {
+        return k < reused ? freeSlots[freeCount - 1 - k]
+                          : static_cast<uint32_t>(firstNewSlot + (k - reused));
+    };
+
+    vector<size_t> accepted;
+    accepted.reserve(batch.size());
+    slotOf.reserve(slotOf.size() + batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        EmployeeError error = EmployeeError::NONE;
+        if (!batch[i]) {
+            error = EmployeeError::NULL_EMPLOYEE;
+        } else if (contains(batch[i]->getEmployeeId())) {
+            error = EmployeeError::DUPLICATE_ID;
+        }
+        if (error != EmployeeError::NONE) {
+            if (rejects) {
+                rejects->push_back({i, batch[i] ? batch[i]->getEmployeeId() : 0, error});
+                continue;
+            }
+            for (size_t j : accepted) {
+                slotOf.erase(batch[j]->getEmployeeId());
+            }
+            throw invalid_argument(employeeErrorMessage(error));
+        }
+        slotOf.insert(batch[i]->getEmployeeId(), slotFor(accepted.size()));
+        accepted.push_back(i);
+    }
+
+    // nothing can fail from here on
+    const size_t oldSize = heap.size();
+    const size_t taken = min(reused, accepted.size());
+    heap.reserve(oldSize + accepted.size());
+    payload.resize(firstNewSlot + (accepted.size() - taken));
+    heapPos.resize(payload.size());
+    indexKeys.resize(payload.size());
+    for (size_t k = 0; k < accepted.size(); k++) {
+        EmployeeHandle& employee = batch[accepted[k]];
+        uint32_t slot = slotFor(k);
+        heapPos[slot] = heap.size();
+        heap.push_back({employee->getSalary(), employee->getEmployeeId(), slot});
+        payload[slot] = move(employee);
+        indexSlot(slot);
+        countPayroll(slot, heap.back().salary);
+        if (versions) {
+            versions->set(slot, *payload[slot]);
+        }
+        if (listener) {
+            listener->employeeInserted(*payload[slot]);
+        }
+    }
+    freeSlots.resize(freeCount - taken);
+    sortedViewValid = false;
+
+    // a small batch into a big heap is cheaper to sift in one by one than to rebuild everything.
+    // same for the salary index (if there is one yet): a few inserts, or drop it and let the next query rebuild
+    if (accepted.size() < oldSize / 16) {
+        for (size_t pos = oldSize; pos < heap.size(); pos++) {
+            if (bySalaryBuilt) {
+                bySalary.insert(heap[pos].salary, heap[pos].employeeId);
+            }
+            siftUp(pos);
+        }
+    } else {
+        bySalaryBuilt = false;
+        heapify(); //can bring a tombstone to the top
+    }
+    popTombstones();
+}
+
+void EmployeePriorityQueue::insertBatch(const vector<Employee*>& batch) {
+    vector<EmployeeHandle> handles;
+    handles.reserve(batch.size());
+    for (Employee* employee : batch) {
+        handles.emplace_back(employee);
+    }
+    try {
+        appendBatch(handles, nullptr);
+    }
+    catch (...) {
+        for (EmployeeHandle& employee : handles) {
+            employee.release(); //give ownership back to the caller, like insert(Employee*)
+        }
+        throw;
+    }
+}
+
+void EmployeePriorityQueue::insertBatch(vector<EmployeeHandle> batch) {
+    appendBatch(batch, nullptr);
+}
+
+vector<BatchReject> EmployeePriorityQueue::tryInsertBatch(vector<EmployeeHandle>& batch) {
+    vector<BatchReject> rejects;
+    appendBatch(batch, &rejects);
+    return rejects;
 }
 
 void EmployeePriorityQueue::insert(Employee* employee) {
+    //check before taking ownership so a failed insert leaves the pointer with the caller, like before
+    if (employee && contains(employee->getEmployeeId())) {
+        throw invalid_argument("employee with this ID already exists");
+    }
+    insert(EmployeeHandle(employee));
+}
+
+void EmployeePriorityQueue::insert(EmployeeHandle employee) {
+    EmployeeError error = tryInsert(move(employee));
+    if (error != EmployeeError::NONE) {
+        throw invalid_argument(employeeErrorMessage(error)); //employee is destroyed on the way out
+    }
+}
+
+EmployeeError EmployeePriorityQueue::tryInsert(EmployeeHandle&& employee) {
+    EMPLOYEE_METRICS_TIME(QueueOp::INSERT);
     if (!employee) {
-        throw invalid_argument("can't insert null employee");
+        return EmployeeError::NULL_EMPLOYEE;
     }
     
-    //check for duplicates in id s
-    auto it = find_if(employees.begin(), employees.end(),
-        [employee](const Employee* emp) {
-            return emp->getEmployeeId() == employee->getEmployeeId();
-        });
-    //if we didn't get to the last id (without returning), then we found a duplicate
-    if (it != employees.end()) {
-        throw invalid_argument("employee with this ID already exists");
+    //check for duplicates in id s, the index makes this a hash lookup instead of a scan
+    if (contains(employee->getEmployeeId())) {
+        return EmployeeError::DUPLICATE_ID;
     }
-    employees.push_back(employee);
+    HeapEntry entry = {employee->getSalary(), employee->getEmployeeId(), 0};
+    entry.slot = acquireSlot(move(employee));
+    heap.push_back(entry);
+    sortedViewValid = false;
     
     // maintain the priority based on the salary
-    push_heap(employees.begin(), employees.end(),
-        [](const Employee* a, const Employee* b) {
-            return a->getSalary() < b->getSalary();
-        });
+    siftUp(heap.size() - 1);
+    if (listener) {
+        listener->employeeInserted(*payload[entry.slot]);
+    }
+    return EmployeeError::NONE;
 }
 
 //pop/remove employee with biggest salary
-Employee* EmployeePriorityQueue::extractMax() {
-    if (employees.empty()) {
+EmployeeHandle EmployeePriorityQueue::extractMax() {
+    EMPLOYEE_METRICS_TIME(QueueOp::EXTRACT_MAX);
+    if (heap.empty()) {
         return nullptr;
     }
     
-    pop_heap(employees.begin(), employees.end(),
-        [](const Employee* a, const Employee* b) {
-            return a->getSalary() < b->getSalary();
-        });
-    
-    Employee* maxEmployee = employees.back();
-    employees.pop_back();
+    int employeeId = heap.front().employeeId;
+    EmployeeHandle maxEmployee = releaseSlot(heap.front().slot, employeeId);
+    removeAt(0);
+    compactIfNeeded(); //the heap got smaller, so the tombstones' share went up
+    popTombstones();
+    sortedViewValid = false;
+    if (listener) {
+        listener->employeeRemoved(employeeId);
+    }
     return maxEmployee;
 }
 //only peek the biggest salary person, don't pop
 Employee* EmployeePriorityQueue::peek() const {
-    if (employees.empty()) {
+    EMPLOYEE_METRICS_COUNT(QueueCounter::PEEK, 1);
+    if (heap.empty()) {
         return nullptr;
     }
-    return employees.front();
+    return payload[heap.front().slot].get();
+}
+
+Employee* EmployeePriorityQueue::find(int employeeId) const {
+    uint32_t slot = slotOf.find(employeeId);
+    if (slot == IdSlotMap::npos) {
+        return nullptr;
+    }
+    return payload[slot].get();
 }
 
 
 //remove an employee based on their id number
 void EmployeePriorityQueue::remove(int employeeId) {
-    auto it = find_if(employees.begin(), employees.end(),
-        [employeeId](const Employee* emp) {
-            return emp->getEmployeeId() == employeeId;
-        });
+    EMPLOYEE_METRICS_TIME(QueueOp::REMOVE);
+    uint32_t slot = slotOf.find(employeeId);
     
-    if (it == employees.end()) { //reached end, nothing matched
+    if (slot == IdSlotMap::npos) { //not indexed, nothing matched
         throw invalid_argument("employee not found");
     }
     
-    delete *it;
-    employees.erase(it);
-    
-    // rebuild the peiority queue after removal
-    make_heap(employees.begin(), employees.end(),
-        [](const Employee* a, const Employee* b) {
-            return a->getSalary() < b->getSalary();
-        });
+    if (lazyThreshold > 0.0) {
+        bury(slot, employeeId);
+        compactIfNeeded();
+        popTombstones();
+    } else {
+        size_t pos = heapPos[slot];
+        releaseSlot(slot, employeeId); //dropping the handle frees the employee
+        removeAt(pos);
+    }
+    sortedViewValid = false;
+    if (listener) {
+        listener->employeeRemoved(employeeId);
+    }
 }
 
-//display fucntion
-void EmployeePriorityQueue::print() const {
-    if (employees.empty()) {
-        cout << "priority queue is empty" << endl;
+// a small batch goes one sift at a time like remove(). a big one (or any batch in lazy mode) turns into
+// tombstones in slot order, so the per slot tables and the pool's blocks are walked front to back instead of
+// at random, then compacts once
+size_t EmployeePriorityQueue::removeBatch(const vector<int>& ids) {
+    EMPLOYEE_METRICS_TIME(QueueOp::REMOVE_BATCH);
+    size_t removed = 0;
+    if (lazyThreshold == 0.0 && ids.size() < heap.size() / 16) {
+        for (int employeeId : ids) {
+            uint32_t slot = slotOf.find(employeeId);
+            if (slot == IdSlotMap::npos) {
+                continue;
+            }
+            size_t pos = heapPos[slot];
+            releaseSlot(slot, employeeId);
+            removeAt(pos);
+            removed++;
+            if (listener) {
+                listener->employeeRemoved(employeeId);
+            }
+        }
+    } else {
+        vector<pair<uint32_t, int>> found; // slot, id
+        found.reserve(ids.size());
+        for (int employeeId : ids) {
+            uint32_t slot = slotOf.find(employeeId);
+            if (slot != IdSlotMap::npos) {
+                found.push_back({slot, employeeId});
+            }
+        }
+        sort(found.begin(), found.end());
+        found.erase(unique(found.begin(), found.end()), found.end()); //repeated ids
+        for (const pair<uint32_t, int>& entry : found) {
+            bury(entry.first, entry.second);
+            if (listener) {
+                listener->employeeRemoved(entry.second);
+            }
+        }
+        removed = found.size();
+        if (lazyThreshold > 0.0) {
+            compactIfNeeded();
+            popTombstones();
+        } else {
+            compact();
+        }
+    }
+    if (removed > 0) {
+        sortedViewValid = false;
+    }
+    return removed;
+}
+
+void EmployeePriorityQueue::setLazyRemoval(double threshold) {
+    if (!(threshold >= 0.0 && threshold < 1.0)) {
+        throw invalid_argument("lazy removal threshold must be at least 0 and below 1");
+    }
+    lazyThreshold = threshold;
+    if (threshold == 0.0) {
+        compact();
+    }
+}
+
+void EmployeePriorityQueue::bury(uint32_t slot, int employeeId) {
+    detachSlot(slot, employeeId);
+    heap[heapPos[slot]].employeeId = 0;
+    tombstones++;
+}
+
+// only the entries pulled in from the end move. shifting everyone left instead would rewrite the heap
+// position of every live slot, a cache miss each, and cost several times the heapify
+void EmployeePriorityQueue::dropTombstones() {
+    if (tombstones == 0) {
         return;
     }
-    
+    EMPLOYEE_METRICS_COUNT(QueueCounter::SCAN_COMPACT, 1);
+    size_t end = heap.size();
+    size_t pos = 0;
+    while (pos < end) {
+        if (!isTombstone(heap[pos])) {
+            pos++;
+            continue;
+        }
+        freeSlots.push_back(heap[pos].slot);
+        end--;
+        while (pos < end && isTombstone(heap[end])) {
+            freeSlots.push_back(heap[end].slot);
+            end--;
+        }
+        if (pos < end) {
+            placeAt(pos, heap[end]);
+            pos++;
+        }
+    }
+    heap.resize(end);
+    tombstones = 0;
+}
+
+void EmployeePriorityQueue::compact() {
+    if (tombstones > 0) {
+        dropTombstones();
+        heapify();
+    }
+}
+
+void EmployeePriorityQueue::compactIfNeeded() {
+    if (tombstones > 0 && tombstones > lazyThreshold * heap.size()) {
+        compact();
+    }
+}
+
+// a tombstone at the root is taken out like extractMax takes out a live one, its slot is free after that
+void EmployeePriorityQueue::popTombstones() {
+    while (tombstones > 0 && !heap.empty() && isTombstone(heap.front())) {
+        freeSlots.push_back(heap.front().slot);
+        tombstones--;
+        removeAt(0);
+    }
+}
+
+uint32_t EmployeePriorityQueue::beginUpdate(int employeeId) {
+    uint32_t slot = slotOf.find(employeeId);
+    if (slot == IdSlotMap::npos) {
+        throw invalid_argument("employee not found");
+    }
+    double salary = heap[heapPos[slot]].salary;
+    uncountPayroll(slot, salary);
+    unindexSlot(slot);
+    if (bySalaryBuilt) {
+        bySalary.erase(salary, employeeId);
+    }
+    return slot;
+}
+
+// level and technology may have changed too, so the slot goes back into every index, not just the salary ones
+void EmployeePriorityQueue::finishUpdate(uint32_t slot) {
+    EMPLOYEE_METRICS_TIME(QueueOp::UPDATE);
+    const Employee& employee = *payload[slot];
+    double salary = employee.getSalary();
+    indexSlot(slot);
+    countPayroll(slot, salary);
+    if (bySalaryBuilt) {
+        bySalary.insert(salary, employee.getEmployeeId());
+    }
+    if (versions) {
+        versions->set(slot, employee);
+    }
+
+    size_t pos = heapPos[slot];
+    double oldSalary = heap[pos].salary;
+    heap[pos].salary = salary;
+    if (oldSalary < salary) {
+        siftUp(pos);
+    } else if (salary < oldSalary) {
+        siftDown(pos);
+        popTombstones(); //a pay cut at the top can bring one up
+    }
+    sortedViewValid = false;
+    if (listener) {
+        listener->employeeUpdated(employee);
+    }
+}
+
+// the class/level/technology indexes stay as they are, only the salary keyed state is redone.
+// callers drop the tombstones first, their slots' index keys are stale
+void EmployeePriorityQueue::rebuildSalaryOrder() {
+    for (PayrollAggregate& total : payrollGroups) {
+        total = PayrollAggregate();
+    }
+    for (const HeapEntry& entry : heap) {
+        countPayroll(entry.slot, entry.salary);
+    }
+    bySalaryBuilt = false;
+    if (versions) {
+        versions->reset(payload);
+    }
+    heapify();
+    sortedViewValid = false;
+}
+
+void EmployeePriorityQueue::advanceExperience(int months) {
+    for (const EmployeeHandle& employee : payload) {
+        if (employee && employee->getExperience() + months < 0) {
+            throw invalid_argument(employeeErrorMessage(EmployeeError::NEGATIVE_EXPERIENCE));
+        }
+    }
+
+    dropTombstones(); //the heap gets rebuilt anyway
+    for (HeapEntry& entry : heap) {
+        Employee& employee = *payload[entry.slot];
+        employee.setExperience(employee.getExperience() + months);
+        entry.salary = employee.getSalary();
+    }
+    rebuildSalaryOrder();
+
+    if (listener) {
+        for (const HeapEntry& entry : heap) {
+            listener->employeeUpdated(*payload[entry.slot]);
+        }
+    }
+}
+
+// each thread takes a contiguous run of heap entries: its employees and its entries, nothing shared.
+// std::execution::par would need TBB with libstdc++, plain threads do the same job here
+void EmployeePriorityQueue::repriceAll(unsigned threads) {
+    const size_t MinPerThread = 4096; //below this, starting a thread costs more than it saves
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    dropTombstones(); //the heap gets rebuilt anyway
+    size_t workers = max<size_t>(1, min<size_t>(threads, heap.size() / MinPerThread));
+
+    auto reprice = [this](size_t begin, size_t end) {
+        for (size_t pos = begin; pos < end; pos++) {
+            Employee& employee = *payload[heap[pos].slot];
+            employee.refreshSalary();
+            heap[pos].salary = employee.getSalary();
+        }
+    };
+    vector<thread> pool;
+    size_t chunk = (heap.size() + workers - 1) / workers;
+    for (size_t w = 1; w < workers; w++) {
+        pool.emplace_back(reprice, w * chunk, min(heap.size(), (w + 1) * chunk));
+    }
+    reprice(0, min(heap.size(), chunk)); //this thread does the first run
+    for (thread& worker : pool) {
+        worker.join();
+    }
+    rebuildSalaryOrder();
+}
+
+//display fucntion
+void printEmployeeTableHeader() {
     cout << "\nEmployee priority queue (salary):\n";
     cout << setw(5) << "ID" << setw(20) << "name"
               << setw(15) << "salary" << setw(15) << "exp\n";
     cout << string(55, '-') << endl;
-    
-    // create a copy of the vector to sort without modifying the original heap
-    vector<Employee*> sortedEmployees = employees;
+}
 
-    sort(sortedEmployees.begin(), sortedEmployees.end(),
-        [](const Employee* a, const Employee* b) {
-            return a->getSalary() > b->getSalary();
-        });
-    
-    for (const Employee* emp : sortedEmployees) {
-        cout << setw(5) << emp->getEmployeeId()
-                  << setw(20) << emp->getName()
-                  << setw(15) << fixed << setprecision(2) << emp->getSalary()
-                  << setw(15) << emp->getExperience() << " months\n";
+void printEmployeeRow(int id, string_view name, double salary, int experience) {
+    cout << setw(5) << id
+              << setw(20) << name
+              << setw(15) << fixed << setprecision(2) << salary
+              << setw(15) << experience << " months\n";
+}
+
+// walk the shortest posting list the query touches and check the other conditions per slot, O(1) each
+template<class Visit>
+void EmployeePriorityQueue::visitMatches(const EmployeeQuery& query, Visit visit) const {
+    uint8_t wanted[IndexKindCount] = {NotIndexed, NotIndexed, NotIndexed, NotIndexed};
+    if (query.eClass) {
+        wanted[BY_CLASS] = static_cast<uint8_t>(*query.eClass);
+    }
+    if (query.level) {
+        wanted[BY_LEVEL] = static_cast<uint8_t>(*query.level);
+    }
+    if (query.backendTechnology) {
+        wanted[BY_BACKEND] = static_cast<uint8_t>(*query.backendTechnology);
+    }
+    if (query.frontendTechnology) {
+        wanted[BY_FRONTEND] = static_cast<uint8_t>(*query.frontendTechnology);
+    }
+
+    const vector<uint32_t>* shortest = nullptr;
+    for (size_t kind = 0; kind < IndexKindCount; kind++) {
+        if (wanted[kind] != NotIndexed) {
+            const vector<uint32_t>& list = postings[kind][wanted[kind]];
+            if (!shortest || list.size() < shortest->size()) {
+                shortest = &list;
+            }
+        }
+    }
+
+    if (!shortest) { //no filter at all, that's everybody
+        for (const HeapEntry& entry : heap) {
+            if (!isTombstone(entry)) {
+                visit(entry.slot);
+            }
+        }
+        return;
+    }
+    for (uint32_t slot : *shortest) {
+        const IndexKeys& keys = indexKeys[slot];
+        bool match = true;
+        for (size_t kind = 0; kind < IndexKindCount && match; kind++) {
+            match = wanted[kind] == NotIndexed || keys.value[kind] == wanted[kind];
+        }
+        if (match) {
+            visit(slot);
+        }
+    }
+}
+
+vector<const Employee*> EmployeePriorityQueue::findEmployees(const EmployeeQuery& query) const {
+    vector<const Employee*> result;
+    visitMatches(query, [&](uint32_t slot) {
+        result.push_back(payload[slot].get());
+    });
+    return result;
+}
+
+size_t EmployeePriorityQueue::countEmployees(const EmployeeQuery& query) const {
+    size_t count = 0;
+    visitMatches(query, [&](uint32_t) {
+        count++;
+    });
+    return count;
+}
+
+// one sort and a linear rebuild the first time, after that every change keeps it current
+const SalaryIndex& EmployeePriorityQueue::salaryIndex() const {
+    if (!bySalaryBuilt) {
+        EMPLOYEE_METRICS_COUNT(QueueCounter::SCAN_SALARY_INDEX, 1);
+        vector<pair<double, int>> keys;
+        keys.reserve(size());
+        for (const HeapEntry& entry : heap) {
+            if (!isTombstone(entry)) {
+                keys.push_back({entry.salary, entry.employeeId});
+            }
+        }
+        sort(keys.begin(), keys.end());
+        bySalary.rebuild(keys);
+        bySalaryBuilt = true;
+    }
+    return bySalary;
+}
+
+vector<const Employee*> EmployeePriorityQueue::rangeBySalary(double low, double high) const {
+    vector<const Employee*> result;
+    salaryIndex().forEachInRange(low, high, [&](double, int employeeId) {
+        result.push_back(payload[slotOf.find(employeeId)].get());
+    });
+    return result;
+}
+
+size_t EmployeePriorityQueue::rankOf(int employeeId) const {
+    uint32_t slot = slotOf.find(employeeId);
+    if (slot == IdSlotMap::npos) {
+        throw invalid_argument("employee not found");
+    }
+    // everyone after this key in ascending order is ranked above it
+    const HeapEntry& entry = heap[heapPos[slot]];
+    const SalaryIndex& index = salaryIndex();
+    return index.size() - index.countLess(entry.salary, entry.employeeId);
+}
+
+double EmployeePriorityQueue::percentile(double p) const {
+    if (!(p >= 0.0 && p <= 100.0)) {
+        throw invalid_argument("percentile must be between 0 and 100");
+    }
+    if (heap.empty()) {
+        throw invalid_argument("priority queue is empty");
+    }
+    const SalaryIndex& index = salaryIndex();
+    size_t rank = static_cast<size_t>(ceil(p / 100.0 * index.size())); // 1 based
+    return index.select(rank == 0 ? 0 : rank - 1).first;
+}
+
+// sorting happens at most once per change to the queue, repeated reports reuse the result
+const vector<HeapEntry>& EmployeePriorityQueue::sortedEntries() const {
+    if (!sortedViewValid) {
+        EMPLOYEE_METRICS_COUNT(QueueCounter::SCAN_SORT, 1);
+        sortedView.clear();
+        sortedView.reserve(size());
+        for (const HeapEntry& entry : heap) {
+            if (!isTombstone(entry)) {
+                sortedView.push_back(entry);
+            }
+        }
+        sort(sortedView.begin(), sortedView.end(),
+            [](const HeapEntry& a, const HeapEntry& b) {
+                return a.salary > b.salary;
+            });
+        sortedViewValid = true;
+    }
+    return sortedView;
+}
+
+void EmployeePriorityQueue::enableSnapshots() {
+    if (!versions) {
+        versions = make_unique<VersionedRows>();
+        versions->reset(payload);
+    }
+}
+
+QueueVersion EmployeePriorityQueue::snapshot() const {
+    if (!versions) {
+        throw runtime_error("snapshots aren't enabled on this queue");
+    }
+    return QueueVersion(versions->current());
+}
+
+QueueMemoryUsage EmployeePriorityQueue::memoryUsage() const {
+    QueueMemoryUsage usage;
+    usage.heapBytes = heap.capacity() * sizeof(HeapEntry);
+    usage.slotBytes = payload.capacity() * sizeof(EmployeeHandle) + heapPos.capacity() * sizeof(size_t) +
+                      freeSlots.capacity() * sizeof(uint32_t) + indexKeys.capacity() * sizeof(IndexKeys);
+    usage.idMapBytes = slotOf.memoryBytes();
+    for (const auto& kind : postings) {
+        for (const vector<uint32_t>& slots : kind) {
+            usage.indexBytes += slots.capacity() * sizeof(uint32_t);
+        }
+    }
+    usage.salaryIndexBytes = bySalary.memoryBytes();
+    usage.sortedViewBytes = sortedView.capacity() * sizeof(HeapEntry);
+    return usage;
+}
+
+void EmployeePriorityQueue::print() const {
+    if (heap.empty()) {
+        cout << "priority queue is empty" << endl;
+        return;
+    }
+    printRange(0, heap.size());
+}
+
+void EmployeePriorityQueue::printRange(size_t offset, size_t count) const {
+    EMPLOYEE_METRICS_TIME(QueueOp::PRINT);
+    printEmployeeTableHeader();
+
+    const vector<HeapEntry>& sorted = sortedEntries();
+    size_t end = offset + min(count, sorted.size() - min(offset, sorted.size()));
+    for (size_t i = offset; i < end; i++) {
+        const Employee* emp = payload[sorted[i].slot].get();
+        printEmployeeRow(emp->getEmployeeId(), emp->getName(), emp->getSalary(), emp->getExperience());
     }
     cout << endl;
-}
\ No newline at end of file
+}
+
+// best first walk of the heap: the next biggest is always the root or a child of something already taken,
+// so a small candidate heap of heap positions is enough
+vector<const Employee*> EmployeePriorityQueue::topK(size_t k) const {
+    k = min(k, size());
+    vector<const Employee*> result;
+    result.reserve(k);
+    if (sortedViewValid) {
+        for (size_t i = 0; i < k; i++) {
+            result.push_back(payload[sortedView[i].slot].get());
+        }
+        return result;
+    }
+
+    auto lessPaid = [this](size_t a, size_t b) {
+        return heap[a].salary < heap[b].salary;
+    };
+    vector<size_t> candidates;
+    if (k > 0) {
+        candidates.push_back(0);
+    }
+    while (result.size() < k) {
+        pop_heap(candidates.begin(), candidates.end(), lessPaid);
+        size_t pos = candidates.back();
+        candidates.pop_back();
+        if (!isTombstone(heap[pos])) { //a tombstone isn't taken, but its children are still candidates
+            result.push_back(payload[heap[pos].slot].get());
+        }
+
+        size_t first = arity * pos + 1;
+        size_t last = min(first + arity, heap.size());
+        for (size_t child = first; child < last; child++) {
+            candidates.push_back(child);
+            push_heap(candidates.begin(), candidates.end(), lessPaid);
+        }
+    }
+    return result;
+}
@@ -6,6 +6,12 @@ using namespace std;
 #include <string>
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <memory>
+#include <array>
+#include <string_view>
+#include <optional>
+#include "employee_salary_index.h"
 
 //enum for employee types
 enum class EmployeeClass {
@@ -39,10 +45,88 @@ enum class FrontendTechnology {
     VUE
 };
 
+// how many values each enum has, for tables indexed by enum
+const size_t EmployeeClassCount = 7;
+const size_t QualificationLevelCount = 3;
+const size_t TechnologyCount = 3; // both backend and frontend have 3
+
+// every rate the salary rules use, as tables indexed by the enums
+struct SalaryPolicy {
+    array<double, EmployeeClassCount> baseSalary;
+    array<double, QualificationLevelCount> qualificationMultiplier;
+    array<double, TechnologyCount> backendTechBonus;  // by BackendTechnology
+    array<double, TechnologyCount> frontendTechBonus; // by FrontendTechnology
+    double experienceBonusPerYear;
+};
+
+// the rates the company started with
+constexpr SalaryPolicy DefaultSalaryPolicy = {
+    {15000.0, 10000.0, 7000.0, 6500.0, 8000.0, 7500.0, 5500.0}, // CIO PM BD FD DB DE TST. frontend < backend 0o0
+    {1.0, 1.50, 2.0},   // JUNIOR MIDDLE SENIOR
+    {1.15, 1.10, 1.05}, // NET SPRING DJANGO
+    {1.10, 1.15, 1.05}, // ANGULAR REACT VUE
+    0.10                // 10% bonus a year
+};
+
+// the policy the salary rules read. setSalaryPolicy throws on rates that aren't positive and finite.
+// existing employees keep their old salary until they're repriced (EmployeePriorityQueue::repriceAll).
+// not synchronized: don't swap it while other threads are calculating salaries
+const SalaryPolicy& salaryPolicy();
+void setSalaryPolicy(const SalaryPolicy& policy);
+
+// the checks setSalaryPolicy makes, for anything that reads rates in (the policy file loader)
+bool validSalaryRate(double rate);           // base salaries, multipliers, tech bonuses: positive and finite
+bool validExperienceBonus(double perYear);   // can be 0 (no raise for experience), not negative or infinite
+
+// salary rules, shared by the calculateSalary overrides and the batch kernel in employee_table
+double getBaseSalary(EmployeeClass eClass);
+double getQualificationMultiplier(QualificationLevel level);
+double getExperienceBonus(int months);
+double getBackendTechBonus(BackendTechnology tech);
+double getFrontendTechBonus(FrontendTechnology tech);
+
+// enum <-> text for loaders and reports. the parse functions return false on text they don't know
+const char* employeeClassName(EmployeeClass eClass);
+const char* qualificationLevelName(QualificationLevel level);
+const char* technologyName(EmployeeClass eClass, uint8_t technology); // "" for roles without a technology
+bool parseEmployeeClass(string_view text, EmployeeClass& out);
+bool parseQualificationLevel(string_view text, QualificationLevel& out);
+bool parseTechnology(EmployeeClass eClass, string_view text, uint8_t& out);
+
+// flat description of any employee, enough to build it again with EmployeePool::create(spec)
+struct EmployeeSpec {
+    string_view name; // not owned
+    int id = 0;
+    EmployeeClass eClass = EmployeeClass::CIO;
+    int experience = 0;
+    QualificationLevel level = QualificationLevel::JUNIOR; // ignored for CIO/PM
+    uint8_t technology = 0; // BackendTechnology for BD, FrontendTechnology for FD, ignored otherwise
+};
+
+// error codes for the non throwing path (bulk loading), where exceptions would cost too much per bad row
+enum class EmployeeError {
+    NONE,
+    EMPTY_NAME,
+    INVALID_ID,
+    NEGATIVE_EXPERIENCE,
+    UNKNOWN_CLASS,
+    UNKNOWN_LEVEL,
+    UNKNOWN_TECHNOLOGY,
+    NULL_EMPLOYEE,
+    DUPLICATE_ID
+};
+
+// same text the exceptions carry
+const char* employeeErrorMessage(EmployeeError error);
+
+// the checks the constructors throw on, as error codes. validateEmployee also checks the enum values
+EmployeeError checkEmployeeFields(string_view name, int id, int experience);
+EmployeeError validateEmployee(const EmployeeSpec& spec);
+
 // abstract base class Employee
 class Employee {
 protected:
-    string name;
+    string_view name; // interned in employeeNames(), so it costs 16 bytes here and nothing per copy
     int employeeId;
     EmployeeClass employeeClass; //using enums
     double salary;
@@ -50,18 +134,27 @@ protected:
 
 public:
     // explicit constructor.  when used by a child class, you manually enter the eClass yourself
-    Employee(const string& name, int id, EmployeeClass eClass, int experience);
+    // throws invalid_argument on bad input, use EmployeePool::tryCreate to get an error code instead
+    Employee(string_view name, int id, EmployeeClass eClass, int experience);
     
     // pure virtual function to allow for overriding //=0 forces child classes to override
     //salary calculations need to be overriden bc different people get different base/bonus salary
     virtual double calculateSalary() = 0;
     
     // getters, inline implementations bc they're short
-    string getName() const { return name; }
+    string_view getName() const { return name; }
     int getEmployeeId() const { return employeeId; }
     EmployeeClass getEmployeeClass() const { return employeeClass; }
     double getSalary() const { return salary; }
     int getExperience() const { return experienceMonths; }
+
+    // setters recompute the salary. an employee that's in a queue has to be changed through updateEmployee
+    // (or the heap goes out of order), everywhere else they can be called directly
+    void setExperience(int months);
+    void refreshSalary() { salary = calculateSalary(); } // after a salary policy change
+
+    // children fill in their own extra fields. the spec's name points into the name arena
+    virtual EmployeeSpec describe() const;
     
     //destructor needs to be virtual so children also clean fully
     virtual ~Employee() = default;
@@ -73,23 +166,25 @@ protected:
     QualificationLevel qualificationLevel;
 
 public:
-    QualifiedEmployee(const string& name, int id, EmployeeClass eClass, 
+    QualifiedEmployee(string_view name, int id, EmployeeClass eClass, 
                      int experience, QualificationLevel level);
     
     QualificationLevel getQualificationLevel() const { return qualificationLevel; }
+    void setQualificationLevel(QualificationLevel level);
+    virtual EmployeeSpec describe() const override;
 };
 
 // now specific employee types
 
 class CIO : public Employee {
 public:
-    CIO(const string& name, int id, int experience);
+    CIO(string_view name, int id, int experience);
     virtual double calculateSalary() override; //as said, different  versions of salary calc are needed
 };
 
 class ProjectManager : public Employee {
 public:
-    ProjectManager(const string& name, int id, int experience);
+    ProjectManager(string_view name, int id, int experience);
     virtual double calculateSalary() override;
 };
 
@@ -100,10 +195,12 @@ private:
     BackendTechnology technology; //technology types backend can have
 
 public:
-    BackendDeveloper(const string& name, int id, int experience,
+    BackendDeveloper(string_view name, int id, int experience,
                     QualificationLevel level, BackendTechnology tech);
     virtual double calculateSalary() override;
     BackendTechnology getTechnology() const { return technology; }
+    void setTechnology(BackendTechnology tech);
+    virtual EmployeeSpec describe() const override;
 };
 
 class FrontendDeveloper : public QualifiedEmployee {
@@ -111,10 +208,12 @@ private:
     FrontendTechnology technology; //technology types frontend can have
 
 public:
-    FrontendDeveloper(const string& name, int id, int experience,
+    FrontendDeveloper(string_view name, int id, int experience,
                      QualificationLevel level, FrontendTechnology tech);
     virtual double calculateSalary() override;
     FrontendTechnology getTechnology() const { return technology; }
+    void setTechnology(FrontendTechnology tech);
+    virtual EmployeeSpec describe() const override;
 };
 
 
@@ -122,51 +221,337 @@ public:
 
 class DatabaseEngineer : public QualifiedEmployee {
 public:
-    DatabaseEngineer(const string& name, int id, int experience,
+    DatabaseEngineer(string_view name, int id, int experience,
                     QualificationLevel level);
     virtual double calculateSalary() override;
 };
 
 class DevOpsEngineer : public QualifiedEmployee {
 public:
-    DevOpsEngineer(const string& name, int id, int experience,
+    DevOpsEngineer(string_view name, int id, int experience,
                    QualificationLevel level);
     virtual double calculateSalary() override;
 };
 
 class Tester : public QualifiedEmployee {
 public:
-    Tester(const string& name, int id, int experience,
+    Tester(string_view name, int id, int experience,
            QualificationLevel level);
     virtual double calculateSalary() override;
 };
 
 
 
+class EmployeePool; // employee_pool.h
+class VersionedRows; // employee_versions.h
+class QueueVersion;
+
+// owning handle for employees. pool == nullptr means the employee was made with plain new
+struct EmployeeDeleter {
+    EmployeePool* pool = nullptr;
+    void operator()(Employee* employee) const;
+};
+using EmployeeHandle = unique_ptr<Employee, EmployeeDeleter>;
+
+// what the heap actually compares: salary is copied in so sifting never has to chase the Employee pointer
+// 16 bytes, so 4 siblings share one 64 byte cache line
+struct HeapEntry {
+    double salary;
+    int employeeId; // 0 marks a tombstone (lazy removal), real ids are positive
+    uint32_t slot; // where the Employee lives in the payload table
+};
+
+// flat open addressing map from employee id to payload slot
+// unordered_map allocates a node per id and erase walks the bucket chain, that was most of extractMax's time
+// ids are always > 0 (Employee constructor checks it), so 0 marks an empty bucket
+class IdSlotMap {
+private:
+    struct Bucket {
+        int id;
+        uint32_t slot;
+    };
+    vector<Bucket> buckets; // size is always 0 or a power of two
+    size_t count = 0;
+
+    // fibonacci hashing, the high half of the product mixes in every bit of the id
+    size_t home(int id) const {
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(id)) * 0x9E3779B97F4A7C15ull) >> 32)
+               & (buckets.size() - 1);
+    }
+    void grow();
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    uint32_t find(int id) const; // npos if missing
+    void insert(int id, uint32_t slot); // id must not be present yet
+    void erase(int id);
+    void reserve(size_t n);
+    void clear();
+    size_t size() const { return count; }
+    size_t memoryBytes() const { return buckets.capacity() * sizeof(Bucket); }
+};
+
+// an entry insertBatch/tryInsertBatch couldn't take
+struct BatchReject {
+    size_t index; // position in the batch
+    int employeeId; // 0 for a null entry
+    EmployeeError error;
+};
+
+// gets told about every change to a queue, after it happened (the journal is one)
+class QueueListener {
+public:
+    virtual void employeeInserted(const Employee& employee) = 0;
+    virtual void employeeRemoved(int employeeId) = 0; // extractMax shows up as a removal too
+    virtual void employeeUpdated(const Employee& employee) = 0; // after updateEmployee/advanceExperience
+    virtual ~QueueListener() = default;
+};
+
+// filter for findEmployees. unset fields match everyone, set fields must all match
+// a backend/frontend technology only matches BD/FD employees
+struct EmployeeQuery {
+    optional<EmployeeClass> eClass;
+    optional<QualificationLevel> level;
+    optional<BackendTechnology> backendTechnology;
+    optional<FrontendTechnology> frontendTechnology;
+};
+
+// salary histogram for the payroll aggregates: fixed width buckets, the last one also takes everything above it
+const size_t SalaryHistogramBuckets = 32;
+const double SalaryHistogramWidth = 2500.0;
+size_t salaryHistogramBucket(double salary);
+
+// running totals for a group of employees (everyone, one class or one level)
+struct PayrollAggregate {
+    size_t headcount = 0;
+    double totalSalary = 0.0;
+    double minSalary = 0.0; // min/max are 0 for an empty group
+    double maxSalary = 0.0;
+    array<uint32_t, SalaryHistogramBuckets> histogram{};
+
+    double averageSalary() const { return headcount == 0 ? 0.0 : totalSalary / headcount; }
+};
+
+// bytes a queue's own containers have allocated, by what they're for. the employees themselves live in
+// their pool (or on the heap) and their names in the name arena, so they aren't in here
+struct QueueMemoryUsage {
+    size_t heapBytes = 0;
+    size_t slotBytes = 0;        // payload handles, heap positions, free slots, per slot index keys
+    size_t idMapBytes = 0;
+    size_t indexBytes = 0;       // class/level/technology posting lists
+    size_t salaryIndexBytes = 0; // nothing until the first range/rank/percentile query
+    size_t sortedViewBytes = 0;
+
+    size_t total() const { return heapBytes + slotBytes + idMapBytes + indexBytes + salaryIndexBytes + sortedViewBytes; }
+};
+
+// children per heap node. 4 siblings fill a cache line; 8 makes the tree shallower but scans two lines
+const size_t DefaultHeapArity = 4;
+
 // create a priority queue for ranking and storing  employees on salary
 class EmployeePriorityQueue {
 private:
-    vector<Employee*> employees;
+    vector<HeapEntry> heap; // d-ary max heap on salary
+    size_t arity;
+
+    // employees are stored outside the heap, by slot. slots get reused after removals
+    vector<EmployeeHandle> payload;
+    vector<size_t> heapPos; // slot -> position in heap, kept in sync on every move
+    vector<uint32_t> freeSlots;
+    IdSlotMap slotOf; // employee id -> slot
+    QueueListener* listener = nullptr;
+
+    // secondary indexes: a posting list of slots per class, level, backend tech and frontend tech value.
+    // each slot remembers its value and position in every list, so removal is a swap with the last entry
+    enum IndexKind { BY_CLASS, BY_LEVEL, BY_BACKEND, BY_FRONTEND, IndexKindCount };
+    static constexpr uint8_t NotIndexed = 0xFF; // e.g. a CIO has no level, a tester no technology
+    struct IndexKeys {
+        uint8_t value[IndexKindCount];
+        uint32_t position[IndexKindCount];
+    };
+    vector<uint32_t> postings[IndexKindCount][EmployeeClassCount]; // class has the most values (7)
+    vector<IndexKeys> indexKeys; // by slot
+    void indexSlot(uint32_t slot);
+    void unindexSlot(uint32_t slot);
+    template<class Visit> void visitMatches(const EmployeeQuery& query, Visit visit) const; // visit(slot)
+
+    // every (salary, id) in order, for range, rank and percentile queries. built by the first such query
+    // and only kept up to date after that, so queues that never ask don't pay for it on every insert/remove
+    mutable SalaryIndex bySalary;
+    mutable bool bySalaryBuilt = false;
+    const SalaryIndex& salaryIndex() const;
+
+    // payroll aggregates: everyone, then one group per class, then one per level (CIO/PM have none).
+    // counts, sums and histograms change in O(1) per employee. min/max can't be kept that cheaply under removal,
+    // so losing the current min or max just marks the group and the next query rescans it
+    enum { PayrollAll = 0, PayrollClassBase = 1, PayrollLevelBase = 1 + EmployeeClassCount,
+           PayrollGroupCount = 1 + EmployeeClassCount + QualificationLevelCount };
+    mutable PayrollAggregate payrollGroups[PayrollGroupCount];
+    mutable bool payrollExtremesStale[PayrollGroupCount] = {};
+    size_t payrollGroupsOf(uint32_t slot, size_t groups[3]) const; // fills groups, returns how many (2 or 3)
+    void countPayroll(uint32_t slot, double salary);   // after indexSlot
+    void uncountPayroll(uint32_t slot, double salary); // before unindexSlot
+    const PayrollAggregate& payrollGroup(size_t group) const;
+
+    // copy on write rows for snapshot(), nullptr until enableSnapshots()
+    unique_ptr<VersionedRows> versions;
+
+    // lazy removal (setLazyRemoval): remove() takes the employee out of everything but the heap, and its entry
+    // stays behind as a tombstone with id 0 (its slot stays taken until the entry goes). telling one apart
+    // needs only the entry, not its slot. everything that walks the heap skips them, and the root is never one,
+    // so peek/extractMax needn't look
+    double lazyThreshold = 0.0; // share of the heap tombstones may take up before a compaction, 0 = off
+    size_t tombstones = 0;
+    static bool isTombstone(const HeapEntry& entry) { return entry.employeeId == 0; }
+    void bury(uint32_t slot, int employeeId); // detachSlot, and the heap entry becomes a tombstone
+    void dropTombstones(); // one pass filling each hole from the end of the heap, which needs a heapify after
+    void popTombstones();  // off the root until a live employee is on top
+    void compactIfNeeded();
+
+    // heap entries sorted by salary, built on the first report after a change and reused until the next one
+    mutable vector<HeapEntry> sortedView;
+    mutable bool sortedViewValid = false;
+    const vector<HeapEntry>& sortedEntries() const;
+
+    // heap helpers, they keep heapPos up to date
+    void placeAt(size_t pos, const HeapEntry& entry);
+    void siftUp(size_t pos);
+    void siftDown(size_t pos);
+    uint32_t acquireSlot(EmployeeHandle employee);
+    EmployeeHandle releaseSlot(uint32_t slot, int employeeId); // gives back the employee that was stored there
+    EmployeeHandle detachSlot(uint32_t slot, int employeeId);  // the same, but the slot stays taken (tombstones)
+    void removeAt(size_t pos);
+    void heapify(); // O(n) bottom up rebuild of the whole heap
+    // claims ids, appends and heapifies. without rejects: throws and leaves the batch untouched on the first bad entry
+    // with rejects: bad entries are reported and left in the batch, the rest go in
+    void appendBatch(vector<EmployeeHandle>& batch, vector<BatchReject>* rejects);
+    void rebuildSalaryOrder(); // heap entries already hold the new salaries, redo everything keyed on them
+    // updateEmployee's two halves: take the slot out of every index, then put it back with its new salary
+    uint32_t beginUpdate(int employeeId);
+    void finishUpdate(uint32_t slot);
 
 public:
     //construct, destruct
-    EmployeePriorityQueue() = default;
+    explicit EmployeePriorityQueue(size_t arity = DefaultHeapArity);
+    explicit EmployeePriorityQueue(vector<EmployeeHandle> employees, size_t arity = DefaultHeapArity);
     ~EmployeePriorityQueue();
 
     //basic priority queue functionality
+    //the queue owns what gets inserted. a raw pointer must come from new, on error it's left with the caller
     void insert(Employee* employee);
-    Employee* extractMax();
+    void insert(EmployeeHandle employee); //on error the employee is destroyed
+    EmployeeHandle extractMax(); //ownership goes back to the caller
+
+    // bulk loading: ids are checked up front, then everything is appended and heapified once, O(n)
+    // all or nothing. raw pointers stay with the caller on error, handles are destroyed
+    void insertBatch(const vector<Employee*>& batch);
+    void insertBatch(vector<EmployeeHandle> batch);
+
+    // non throwing versions. a rejected employee stays with the caller (tryInsert leaves the handle alone,
+    // tryInsertBatch leaves rejects in the batch and returns them), everything else goes in
+    EmployeeError tryInsert(EmployeeHandle&& employee);
+    vector<BatchReject> tryInsertBatch(vector<EmployeeHandle>& batch);
     Employee* peek() const;
     void remove(int employeeId);
+
+    // removes every listed id that's in the queue and skips the rest (repeats too), returns how many went.
+    // a big batch (1/16 of the queue or more) leaves tombstones and drops them all in one pass and a heapify
+    // instead of a sift per id. listeners hear about a big batch in no particular order
+    size_t removeBatch(const vector<int>& ids);
+
+    // lazy removal for workloads with bursts of removals, off by default. with a threshold in (0, 1),
+    // remove() and removeBatch() leave tombstones in the heap instead of sifting, so a removal costs only the
+    // index updates. once tombstones are more than that share of the heap, one pass drops them all.
+    // 0 turns it off again (and compacts). throws invalid_argument outside [0, 1)
+    void setLazyRemoval(double threshold);
+    void compact(); // drop every tombstone now, O(n), e.g. while the caller has nothing else to do
+    size_t tombstoneCount() const { return tombstones; }
+
+    // change an employee in place and move it to its new spot with one sift, O(log n).
+    // mutate gets the Employee& and uses its setters (experience, level, technology), the id can't change.
+    // throws if the id isn't in the queue. if mutate throws, whatever it already changed is kept
+    template<class Mutator>
+    void updateEmployee(int employeeId, Mutator mutate) {
+        uint32_t slot = beginUpdate(employeeId);
+        try {
+            mutate(*payload[slot]);
+        } catch (...) {
+            finishUpdate(slot);
+            throw;
+        }
+        finishUpdate(slot);
+    }
+    // everyone gains (or loses, if negative) this much experience, then the heap is rebuilt once.
+    // all or nothing: throws before changing anyone if it would leave someone below 0
+    void advanceExperience(int months);
+
+    // recalculate every salary with the current salary policy, spread over threads (0 = one per core),
+    // then rebuild the heap once. listeners aren't told: no employee field changed, only the rates
+    void repriceAll(unsigned threads = 0);
+
+    // lookups by id, O(1)
+    bool contains(int employeeId) const { return slotOf.find(employeeId) != IdSlotMap::npos; }
+    Employee* find(int employeeId) const; // nullptr if not in the queue
     
     // utility
-    bool isEmpty() const { return employees.empty(); }
-    size_t size() const { return employees.size(); }
+    bool isEmpty() const { return heap.empty(); } // tombstones never outlive the last live entry
+    size_t size() const { return heap.size() - tombstones; }
+    size_t getArity() const { return arity; }
+    QueueMemoryUsage memoryUsage() const;
     void print() const;
+
+    // filtered lookups through the secondary indexes. cost follows the smallest matching posting list,
+    // not the size of the queue. results are in no particular order
+    vector<const Employee*> findEmployees(const EmployeeQuery& query) const;
+    size_t countEmployees(const EmployeeQuery& query) const;
+
+    // ordered salary queries, O(log n) each plus the size of the result
+    vector<const Employee*> rangeBySalary(double low, double high) const; // low <= salary <= high, highest first
+    size_t rankOf(int employeeId) const; // 1 is the best paid, equal salaries are ranked by id. throws if not found
+    double percentile(double p) const;   // nearest rank: the lowest salary with at least p% of the queue at or below it
+
+    // payroll totals, kept up to date on every change so they're cheap to poll
+    PayrollAggregate payroll() const { return payrollGroup(PayrollAll); }
+    PayrollAggregate payrollByClass(EmployeeClass eClass) const;
+    PayrollAggregate payrollByLevel(QualificationLevel level) const;
+
+    // reports, highest salary first (ties in no particular order)
+    // topK walks the top of the heap, O(k log k), unless the sorted view is already there
+    vector<const Employee*> topK(size_t k) const;
+    void printRange(size_t offset, size_t count) const; // one page of print()'s table
+
+    // read only view of the heap, in heap order (front is the max). with lazy removal it can hold tombstones,
+    // entries with id 0 that getEmployee() gives nullptr for. the front is never one
+    const vector<HeapEntry>& getHeap() const { return heap; }
+    const Employee* getEmployee(const HeapEntry& entry) const { return payload[entry.slot].get(); }
+    // cache hint for walks in an order the hardware can't predict (like the sorted view): start loading
+    // the payload slot that getEmployee(entry) will read
+    void prefetchEmployee(const HeapEntry& entry) const { __builtin_prefetch(&payload[entry.slot]); }
+    // the live entries sorted highest salary first. cached until the next change, so repeated reports sort once
+    const vector<HeapEntry>& getSortedHeap() const { return sortedEntries(); }
+
+    // consistent views for readers on other threads, while this thread keeps changing the queue.
+    // enableSnapshots() starts keeping a copy on write row table (O(n) once, then a row write per change);
+    // call it before sharing the queue. snapshot() is then O(1) and safe from any thread, the version it
+    // returns never changes and its memory is freed with its last handle. throws runtime_error if not enabled
+    void enableSnapshots();
+    QueueVersion snapshot() const;
+
+    // not owned, nullptr to detach
+    void setListener(QueueListener* queueListener) { listener = queueListener; }
+
+    // binary snapshot of the whole queue, defined in employee_snapshot.cpp. durable once it returns (fsynced,
+    // directory included), throws runtime_error if it couldn't write or sync
+    void save(const string& path) const;
     
     // we do NOT need these, so they're deleted to avoid shallow copy memory issues as we're not using/handling these cases
     EmployeePriorityQueue(const EmployeePriorityQueue&) = delete;
     EmployeePriorityQueue& operator=(const EmployeePriorityQueue&) = delete;
 };
 
+// the table print() shows, also used for printing snapshots
+void printEmployeeTableHeader();
+void printEmployeeRow(int id, string_view name, double salary, int experience);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "employee_meldable.h"
+using namespace std;
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+
+MeldableEmployeeQueue::MeldableEmployeeQueue(vector<EmployeeHandle> employees) {
+    try {
+        for (EmployeeHandle& employee : employees) {
+            insert(move(employee));
+        }
+    }
+    catch (...) {
+        destroyAll(); //no destructor runs for a half built queue
+        throw;
+    }
+}
+
+MeldableEmployeeQueue::~MeldableEmployeeQueue() {
+    destroyAll();
+}
+
+MeldableEmployeeQueue::MeldableEmployeeQueue(MeldableEmployeeQueue&& other) noexcept
+    : root(other.root), nodes(move(other.nodes)), freeSlots(move(other.freeSlots)), slotOf(move(other.slotOf)) {
+    other.root = nullptr;
+    other.nodes.clear();
+    other.freeSlots.clear();
+    other.slotOf.clear(); //a moved from map keeps its count
+}
+
+MeldableEmployeeQueue& MeldableEmployeeQueue::operator=(MeldableEmployeeQueue&& other) noexcept {
+    if (this != &other) {
+        destroyAll();
+        root = other.root;
+        nodes = move(other.nodes);
+        freeSlots = move(other.freeSlots);
+        slotOf = move(other.slotOf);
+        other.root = nullptr;
+        other.nodes.clear();
+        other.freeSlots.clear();
+        other.slotOf.clear();
+    }
+    return *this;
+}
+
+// every node is in the slot table, so no tree walk (and no recursion) is needed to free them
+void MeldableEmployeeQueue::destroyAll() {
+    for (Node* node : nodes) {
+        delete node; //the handle gives the employee back to its pool (or deletes it)
+    }
+    nodes.clear();
+    freeSlots.clear();
+    slotOf.clear();
+    root = nullptr;
+}
+
+// the loser becomes the winner's first child
+MeldableEmployeeQueue::Node* MeldableEmployeeQueue::link(Node* a, Node* b) {
+    if (a->salary < b->salary) {
+        swap(a, b);
+    }
+    b->prev = a;
+    b->next = a->child;
+    if (a->child) {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
+
+// standard two pass pairing: link neighbours left to right, then fold the pairs right to left into one tree.
+// this is where the work put off by inserts and melds (which only link roots) gets done
+MeldableEmployeeQueue::Node* MeldableEmployeeQueue::mergeChildren(Node* first) {
+    if (!first) {
+        return nullptr;
+    }
+    pairing.clear();
+    for (Node* node = first; node;) {
+        Node* a = node;
+        Node* b = a->next;
+        node = b ? b->next : nullptr;
+        a->next = a->prev = nullptr;
+        if (b) {
+            b->next = b->prev = nullptr;
+            a = link(a, b);
+        }
+        pairing.push_back(a);
+    }
+    Node* merged = pairing.back();
+    for (size_t i = pairing.size() - 1; i-- > 0;) {
+        merged = link(pairing[i], merged);
+    }
+    return merged;
+}
+
+uint32_t MeldableEmployeeQueue::acquireSlot(Node* node) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        nodes[slot] = node;
+    } else {
+        slot = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(node);
+    }
+    node->slot = slot;
+    slotOf.insert(node->employeeId, slot);
+    return slot;
+}
+
+EmployeeHandle MeldableEmployeeQueue::releaseNode(Node* node) {
+    slotOf.erase(node->employeeId);
+    nodes[node->slot] = nullptr;
+    freeSlots.push_back(node->slot);
+    EmployeeHandle employee = move(node->employee);
+    delete node;
+    return employee;
+}
+
+void MeldableEmployeeQueue::cut(Node* node) {
+    if (node->prev->child == node) {
+        node->prev->child = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    node->next = node->prev = nullptr;
+}
+
+// take a node out of the tree, its children go back in as one tree
+void MeldableEmployeeQueue::detach(Node* node) {
+    if (node == root) {
+        root = mergeChildren(node->child);
+    } else {
+        cut(node);
+        Node* rest = mergeChildren(node->child);
+        if (rest) {
+            root = link(root, rest);
+        }
+    }
+    node->child = nullptr;
+}
+
+void MeldableEmployeeQueue::insert(Employee* employee) {
+    //check before taking ownership so a failed insert leaves the pointer with the caller
+    if (employee && contains(employee->getEmployeeId())) {
+        throw invalid_argument("employee with this ID already exists");
+    }
+    insert(EmployeeHandle(employee));
+}
+
+void MeldableEmployeeQueue::insert(EmployeeHandle employee) {
+    EmployeeError error = tryInsert(move(employee));
+    if (error != EmployeeError::NONE) {
+        throw invalid_argument(employeeErrorMessage(error)); //employee is destroyed on the way out
+    }
+}
+
+EmployeeError MeldableEmployeeQueue::tryInsert(EmployeeHandle&& employee) {
+    if (!employee) {
+        return EmployeeError::NULL_EMPLOYEE;
+    }
+    if (contains(employee->getEmployeeId())) {
+        return EmployeeError::DUPLICATE_ID;
+    }
+    Node* node = new Node();
+    node->salary = employee->getSalary();
+    node->employeeId = employee->getEmployeeId();
+    node->employee = move(employee);
+    acquireSlot(node);
+    root = root ? link(root, node) : node;
+    return EmployeeError::NONE;
+}
+
+EmployeeHandle MeldableEmployeeQueue::extractMax() {
+    if (!root) {
+        return nullptr;
+    }
+    Node* top = root;
+    detach(top);
+    return releaseNode(top);
+}
+
+Employee* MeldableEmployeeQueue::peek() const {
+    return root ? root->employee.get() : nullptr;
+}
+
+void MeldableEmployeeQueue::remove(int employeeId) {
+    uint32_t slot = slotOf.find(employeeId);
+    if (slot == IdSlotMap::npos) {
+        throw invalid_argument("employee not found");
+    }
+    Node* node = nodes[slot];
+    detach(node);
+    releaseNode(node); //dropping the handle frees the employee
+}
+
+Employee* MeldableEmployeeQueue::find(int employeeId) const {
+    uint32_t slot = slotOf.find(employeeId);
+    if (slot == IdSlotMap::npos) {
+        return nullptr;
+    }
+    return nodes[slot]->employee.get();
+}
+
+void MeldableEmployeeQueue::meld(MeldableEmployeeQueue& other) {
+    if (&other == this) {
+        throw invalid_argument("can't meld a queue with itself");
+    }
+    if (!other.root) {
+        return;
+    }
+    // the id tables of the bigger queue stay, the smaller one's ids are moved over
+    MeldableEmployeeQueue& larger = size() >= other.size() ? *this : other;
+    MeldableEmployeeQueue& smaller = size() >= other.size() ? other : *this;
+    for (Node* node : smaller.nodes) {
+        if (node && larger.contains(node->employeeId)) {
+            throw invalid_argument("employee with this ID already exists");
+        }
+    }
+    if (&larger == &other) {
+        swap(nodes, other.nodes);
+        swap(freeSlots, other.freeSlots);
+        swap(slotOf, other.slotOf);
+    }
+    slotOf.reserve(slotOf.size() + other.slotOf.size());
+    for (Node* node : other.nodes) {
+        if (node) {
+            acquireSlot(node);
+        }
+    }
+    root = root ? link(root, other.root) : other.root;
+    other.root = nullptr;
+    other.nodes.clear();
+    other.freeSlots.clear();
+    other.slotOf.clear();
+}
+
+// each one comes out like remove() takes it out, O(log n) amortized, and goes into the new queue like an insert
+MeldableEmployeeQueue MeldableEmployeeQueue::splitByClass(EmployeeClass eClass) {
+    MeldableEmployeeQueue department;
+    vector<Node*> moving;
+    for (Node* node : nodes) {
+        if (node && node->employee->getEmployeeClass() == eClass) {
+            moving.push_back(node);
+        }
+    }
+    department.slotOf.reserve(moving.size());
+    for (Node* node : moving) {
+        detach(node);
+        slotOf.erase(node->employeeId);
+        nodes[node->slot] = nullptr;
+        freeSlots.push_back(node->slot);
+        department.acquireSlot(node);
+        department.root = department.root ? link(department.root, node) : node;
+    }
+    return department;
+}
+
+void MeldableEmployeeQueue::print() const {
+    if (!root) {
+        cout << "priority queue is empty" << endl;
+        return;
+    }
+    vector<const Node*> sorted;
+    sorted.reserve(size());
+    for (const Node* node : nodes) {
+        if (node) {
+            sorted.push_back(node);
+        }
+    }
+    sort(sorted.begin(), sorted.end(), [](const Node* a, const Node* b) {
+        return a->salary > b->salary;
+    });
+    printEmployeeTableHeader();
+    for (const Node* node : sorted) {
+        const Employee* emp = node->employee.get();
+        printEmployeeRow(emp->getEmployeeId(), emp->getName(), emp->getSalary(), emp->getExperience());
+    }
+    cout << endl;
+}
+
+
+TopEarners::TopEarners(const vector<const EmployeePriorityQueue*>& queues,
+                       const vector<const MeldableEmployeeQueue*>& meldables)
+    : queues(queues) {
+    candidates.reserve(queues.size() + meldables.size());
+    for (size_t i = 0; i < queues.size(); i++) {
+        if (!queues[i]->isEmpty()) {
+            push({queues[i]->getHeap().front().salary, static_cast<uint32_t>(i), 0, nullptr});
+        }
+    }
+    for (const MeldableEmployeeQueue* queue : meldables) {
+        if (queue->root) {
+            push({queue->root->salary, 0, 0, queue->root});
+        }
+    }
+}
+
+void TopEarners::push(const Candidate& candidate) {
+    candidates.push_back(candidate);
+    push_heap(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.salary < b.salary;
+    });
+}
+
+// a heap entry's children (or a node's) are the only entries that can be next in that queue.
+// a tombstone (lazy removal) is passed over, its children are still candidates
+const Employee* TopEarners::next() {
+    while (!candidates.empty()) {
+        pop_heap(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.salary < b.salary;
+        });
+        Candidate best = candidates.back();
+        candidates.pop_back();
+
+        if (best.node) {
+            for (const MeldableEmployeeQueue::Node* child = best.node->child; child; child = child->next) {
+                push({child->salary, 0, 0, child});
+            }
+            return best.node->employee.get();
+        }
+        const EmployeePriorityQueue& queue = *queues[best.queue];
+        const vector<HeapEntry>& heap = queue.getHeap();
+        size_t first = queue.getArity() * best.position + 1;
+        size_t last = min(first + queue.getArity(), heap.size());
+        for (size_t child = first; child < last; child++) {
+            push({heap[child].salary, best.queue, child, nullptr});
+        }
+        if (const Employee* employee = queue.getEmployee(heap[best.position])) {
+            return employee;
+        }
+    }
+    return nullptr;
+}
+
+vector<const Employee*> TopEarners::take(size_t n) {
+    vector<const Employee*> result;
+    while (result.size() < n) {
+        const Employee* employee = next();
+        if (!employee) {
+            break;
+        }
+        result.push_back(employee);
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+#ifndef EMPLOYEE_MELDABLE_H
+#define EMPLOYEE_MELDABLE_H
+
+#include "employee_management.h"
+#include <vector>
+using namespace std;
+
+// salary max queue built for merging: a pairing heap, one node per employee. a meld only touches the smaller
+// queue's employees.
+// meant for one queue per department that get combined in reorgs, where the vector heap would have to
+// re-insert one side. same insert/extractMax/peek/remove/lookups as EmployeePriorityQueue, but none of its
+// extras (secondary indexes, payroll totals, salary index, listener)
+//
+// costs: insert, peek O(1), meld O(min(n, m)), extractMax and remove O(log n) amortized, lookups by id O(1).
+// every step of extractMax chases node pointers, so draining one is about twice as slow as the vector heap
+// at 1M employees: use it where queues get merged, not as a faster EmployeePriorityQueue
+class MeldableEmployeeQueue {
+private:
+    // the tree is kept as first child / next sibling lists. prev is the parent for a first child,
+    // the previous sibling otherwise, so a node can be cut out without searching for it
+    struct Node {
+        double salary;
+        int employeeId;
+        uint32_t slot; // in nodes/slotOf, like the payload slots of the vector heap
+        Node* child = nullptr;
+        Node* next = nullptr;
+        Node* prev = nullptr;
+        EmployeeHandle employee;
+    };
+
+    Node* root = nullptr;
+    vector<Node*> nodes; // by slot, nullptr for a free slot
+    vector<uint32_t> freeSlots;
+    IdSlotMap slotOf;    // employee id -> slot
+    vector<Node*> pairing; // scratch for mergeChildren, kept to avoid an allocation per extractMax
+
+    static Node* link(Node* a, Node* b); // two roots -> one, the better paid one on top
+    Node* mergeChildren(Node* first);    // two pass pairing of a sibling list, returns the new root
+    uint32_t acquireSlot(Node* node);
+    EmployeeHandle releaseNode(Node* node); // frees the node and its slot, hands back the employee
+    void cut(Node* node);                   // take a non-root node (and its subtree) out of the tree
+    void detach(Node* node);                // take any node out, its children stay in the tree
+    void destroyAll();
+
+    friend class TopEarners;
+
+public:
+    MeldableEmployeeQueue() = default;
+    explicit MeldableEmployeeQueue(vector<EmployeeHandle> employees); // throws like insert on a bad entry
+    ~MeldableEmployeeQueue();
+    MeldableEmployeeQueue(MeldableEmployeeQueue&& other) noexcept;
+    MeldableEmployeeQueue& operator=(MeldableEmployeeQueue&& other) noexcept;
+
+    //same ownership rules as EmployeePriorityQueue
+    void insert(Employee* employee);
+    void insert(EmployeeHandle employee);
+    EmployeeError tryInsert(EmployeeHandle&& employee);
+    EmployeeHandle extractMax(); // nullptr when empty
+    Employee* peek() const;
+    void remove(int employeeId); // throws if not found
+
+    // takes everyone from other, leaving it empty. O(min(n, m)): joining the heaps is one link, but the smaller
+    // queue's ids are checked against the bigger one's map and then moved into it. over any series of melds
+    // each id is moved O(log n) times.
+    // throws before changing either queue if they share an id, or if other is this queue
+    void meld(MeldableEmployeeQueue& other);
+
+    // moves every employee of one class into a new queue and returns it. O(n + k log n) amortized for k moved:
+    // one pass over the slots finds them, then each is cut out like remove() and linked in like an insert
+    MeldableEmployeeQueue splitByClass(EmployeeClass eClass);
+
+    bool contains(int employeeId) const { return slotOf.find(employeeId) != IdSlotMap::npos; }
+    Employee* find(int employeeId) const; // nullptr if not in the queue
+    bool isEmpty() const { return root == nullptr; }
+    size_t size() const { return slotOf.size(); }
+    void print() const; // same table as EmployeePriorityQueue::print
+
+    MeldableEmployeeQueue(const MeldableEmployeeQueue&) = delete;
+    MeldableEmployeeQueue& operator=(const MeldableEmployeeQueue&) = delete;
+};
+
+// highest paid first across many queues at once, e.g. a company wide top N over the department queues.
+// nothing is copied or sorted up front: a candidate heap holds the next unvisited entry of every queue,
+// each step takes the best and adds its children, so the first k cost O(k log k) plus the children looked at.
+// a pairing heap that has only had inserts since its last extractMax keeps everyone as children of the root,
+// so its first step looks at all of them. only valid while none of the queues change
+class TopEarners {
+private:
+    struct Candidate {
+        double salary;
+        uint32_t queue;   // index into queues, for an entry of a vector heap
+        size_t position;  // its position in that heap
+        const MeldableEmployeeQueue::Node* node; // set instead for a pairing heap node
+    };
+    vector<const EmployeePriorityQueue*> queues;
+    vector<Candidate> candidates; // max heap on salary
+
+    void push(const Candidate& candidate);
+
+public:
+    explicit TopEarners(const vector<const EmployeePriorityQueue*>& queues,
+                        const vector<const MeldableEmployeeQueue*>& meldables = {});
+
+    const Employee* next(); // nullptr once every queue is used up
+    vector<const Employee*> take(size_t n); // the next n (fewer if the queues run out)
+};
+
+#endif
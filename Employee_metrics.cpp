@@ -0,0 +1,200 @@
+#include "employee_metrics.h"
+#include "employee_names.h"
+using namespace std;
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+
+// every block ever handed out, and the ones whose thread has exited
+struct MetricsRegistry {
+    mutex lock;
+    vector<unique_ptr<ThreadMetrics>> blocks;
+    vector<ThreadMetrics*> idle;
+};
+
+// leaked like employeeNames(), threads can still be exiting after static destructors ran
+MetricsRegistry& registry() {
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return *instance;
+}
+
+#ifdef EMPLOYEE_METRICS
+const char* const OpNames[QueueOpCount] = {"insert", "insert_batch", "remove", "remove_batch", "extract_max", "print", "update"};
+
+// every thread's blocks added up
+struct MetricsTotals {
+    uint64_t counters[QueueCounterCount] = {};
+    uint64_t operations[QueueOpCount] = {};
+    uint64_t latencySum[QueueOpCount] = {};
+    uint64_t latency[QueueOpCount][LatencyBuckets] = {};
+};
+
+void collect(MetricsTotals& totals) {
+    MetricsRegistry& all = registry();
+    lock_guard<mutex> guard(all.lock);
+    for (const unique_ptr<ThreadMetrics>& block : all.blocks) {
+        for (size_t i = 0; i < QueueCounterCount; i++) {
+            totals.counters[i] += block->counters[i].load(memory_order_relaxed);
+        }
+        for (size_t op = 0; op < QueueOpCount; op++) {
+            totals.operations[op] += block->operations[op].load(memory_order_relaxed);
+            totals.latencySum[op] += block->latencySum[op].load(memory_order_relaxed);
+            for (size_t bucket = 0; bucket < LatencyBuckets; bucket++) {
+                totals.latency[op][bucket] += block->latency[op][bucket].load(memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// the bucket holding the sample at fraction q of the way up, reported as the top of that bucket
+uint64_t latencyQuantile(const uint64_t (&buckets)[LatencyBuckets], uint64_t count, double q) {
+    uint64_t rank = static_cast<uint64_t>(q * count);
+    rank = rank < count ? rank : count - 1;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < LatencyBuckets; bucket++) {
+        seen += buckets[bucket];
+        if (seen > rank) {
+            return latencyBucketUpperBound(bucket);
+        }
+    }
+    return latencyBucketUpperBound(LatencyBuckets - 1);
+}
+
+void writeCounters(ostringstream& out, const MetricsTotals& totals) {
+    auto counter = [&](QueueCounter which) {
+        return totals.counters[static_cast<size_t>(which)];
+    };
+
+    out << "# HELP employee_queue_operations_total Queue operations run.\n"
+           "# TYPE employee_queue_operations_total counter\n";
+    for (size_t op = 0; op < QueueOpCount; op++) {
+        out << "employee_queue_operations_total{op=\"" << OpNames[op] << "\"} " << totals.operations[op] << '\n';
+    }
+    out << "employee_queue_operations_total{op=\"peek\"} " << counter(QueueCounter::PEEK) << '\n';
+
+    out << "# HELP employee_queue_operation_latency_seconds Queue operation latency, sampled.\n"
+           "# TYPE employee_queue_operation_latency_seconds summary\n";
+    static const double Quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    for (size_t op = 0; op < QueueOpCount; op++) {
+        uint64_t count = 0;
+        for (uint64_t samples : totals.latency[op]) {
+            count += samples;
+        }
+        if (count > 0) {
+            for (double q : Quantiles) {
+                out << "employee_queue_operation_latency_seconds{op=\"" << OpNames[op] << "\",quantile=\"" << q
+                    << "\"} " << latencyQuantile(totals.latency[op], count, q) * 1e-9 << '\n';
+            }
+        }
+        out << "employee_queue_operation_latency_seconds_sum{op=\"" << OpNames[op] << "\"} "
+            << totals.latencySum[op] * 1e-9 << '\n';
+        out << "employee_queue_operation_latency_seconds_count{op=\"" << OpNames[op] << "\"} " << count << '\n';
+    }
+
+    out << "# HELP employee_queue_sifts_total Heap sift calls.\n"
+           "# TYPE employee_queue_sifts_total counter\n"
+        << "employee_queue_sifts_total{direction=\"up\"} " << counter(QueueCounter::SIFT_UP) << '\n'
+        << "employee_queue_sifts_total{direction=\"down\"} " << counter(QueueCounter::SIFT_DOWN) << '\n';
+    out << "# HELP employee_queue_sift_levels_total Heap levels moved by sifts.\n"
+           "# TYPE employee_queue_sift_levels_total counter\n"
+        << "employee_queue_sift_levels_total{direction=\"up\"} " << counter(QueueCounter::SIFT_UP_LEVELS) << '\n'
+        << "employee_queue_sift_levels_total{direction=\"down\"} " << counter(QueueCounter::SIFT_DOWN_LEVELS) << '\n';
+    out << "# HELP employee_queue_comparisons_total Salary comparisons made by sifts.\n"
+           "# TYPE employee_queue_comparisons_total counter\n"
+        << "employee_queue_comparisons_total " << counter(QueueCounter::COMPARISONS) << '\n';
+    out << "# HELP employee_queue_linear_scans_total Passes over the whole queue.\n"
+           "# TYPE employee_queue_linear_scans_total counter\n"
+        << "employee_queue_linear_scans_total{kind=\"sort\"} " << counter(QueueCounter::SCAN_SORT) << '\n'
+        << "employee_queue_linear_scans_total{kind=\"heapify\"} " << counter(QueueCounter::SCAN_HEAPIFY) << '\n'
+        << "employee_queue_linear_scans_total{kind=\"salary_index\"} " << counter(QueueCounter::SCAN_SALARY_INDEX) << '\n'
+        << "employee_queue_linear_scans_total{kind=\"payroll_minmax\"} "
+        << counter(QueueCounter::SCAN_PAYROLL_MINMAX) << '\n'
+        << "employee_queue_linear_scans_total{kind=\"compact\"} " << counter(QueueCounter::SCAN_COMPACT) << '\n';
+}
+
+#endif
+
+void writeGauges(ostringstream& out, const EmployeePriorityQueue& queue) {
+    QueueMemoryUsage memory = queue.memoryUsage();
+    out << "# HELP employee_queue_size Employees in the queue.\n"
+           "# TYPE employee_queue_size gauge\n"
+        << "employee_queue_size " << queue.size() << '\n';
+    out << "# HELP employee_queue_tombstones Removed employees whose heap entries haven't been dropped yet.\n"
+           "# TYPE employee_queue_tombstones gauge\n"
+        << "employee_queue_tombstones " << queue.tombstoneCount() << '\n';
+    out << "# HELP employee_queue_memory_bytes Memory held by the queue's own containers.\n"
+           "# TYPE employee_queue_memory_bytes gauge\n"
+        << "employee_queue_memory_bytes{part=\"heap\"} " << memory.heapBytes << '\n'
+        << "employee_queue_memory_bytes{part=\"slots\"} " << memory.slotBytes << '\n'
+        << "employee_queue_memory_bytes{part=\"id_map\"} " << memory.idMapBytes << '\n'
+        << "employee_queue_memory_bytes{part=\"indexes\"} " << memory.indexBytes << '\n'
+        << "employee_queue_memory_bytes{part=\"salary_index\"} " << memory.salaryIndexBytes << '\n'
+        << "employee_queue_memory_bytes{part=\"sorted_view\"} " << memory.sortedViewBytes << '\n';
+}
+
+}
+
+ThreadMetricsLease::ThreadMetricsLease() {
+    MetricsRegistry& all = registry();
+    lock_guard<mutex> guard(all.lock);
+    if (!all.idle.empty()) {
+        block = all.idle.back();
+        all.idle.pop_back();
+    } else {
+        all.blocks.push_back(make_unique<ThreadMetrics>());
+        block = all.blocks.back().get();
+    }
+}
+
+ThreadMetricsLease::~ThreadMetricsLease() {
+    MetricsRegistry& all = registry();
+    lock_guard<mutex> guard(all.lock);
+    all.idle.push_back(block); //the counts stay, the next thread keeps adding to them
+}
+
+uint64_t latencyBucketUpperBound(size_t bucket) {
+    if (bucket < LatencySubBuckets) {
+        return bucket;
+    }
+    size_t shift = bucket / LatencySubBuckets - 1; // exponent - LatencySubBucketBits
+    uint64_t low = static_cast<uint64_t>(LatencySubBuckets + bucket % LatencySubBuckets) << shift;
+    return low + ((uint64_t(1) << shift) - 1);
+}
+
+string formatMetrics(const EmployeePriorityQueue* queue) {
+    ostringstream out;
+#ifdef EMPLOYEE_METRICS
+    unique_ptr<MetricsTotals> totals = make_unique<MetricsTotals>(); //24KB, too big for the stack of a worker thread
+    collect(*totals);
+    writeCounters(out, *totals);
+#endif
+    if (queue) {
+        writeGauges(out, *queue);
+    }
+    out << "# HELP employee_name_arena_bytes Employee name bytes interned so far.\n"
+           "# TYPE employee_name_arena_bytes gauge\n"
+        << "employee_name_arena_bytes " << employeeNames().bytesUsed() << '\n';
+    return out.str();
+}
+
+void writeMetrics(const string& path, const EmployeePriorityQueue* queue) {
+    string text = formatMetrics(queue);
+    string tmpPath = path + ".tmp";
+    FILE* out = fopen(tmpPath.c_str(), "wb");
+    if (!out) {
+        throw runtime_error("can't write " + tmpPath);
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), out) == text.size();
+    ok = (fclose(out) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        throw runtime_error("failed writing metrics " + path);
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef EMPLOYEE_METRICS_H
+#define EMPLOYEE_METRICS_H
+
+#include "employee_management.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+// queue instrumentation: operation counts, latency histograms, sift depth/comparison counts and how often
+// the O(n) passes (sort, heapify, index builds, min/max rescans) run. only compiled in with -DEMPLOYEE_METRICS,
+// without it the hooks below expand to nothing and the queue code is what it was.
+// every translation unit has to be built with the same setting
+//
+// recording is per thread: each thread adds into its own block with plain relaxed loads/stores (it's the only
+// writer), no locks and no shared cache lines. writeMetrics adds the blocks up when a dump is asked for.
+//
+// operation counts are exact, latency is sampled: reading the clock waits for the loads before it, so timing
+// every extractMax stopped one operation's cache misses overlapping the next and cost more than the clock
+// itself (~400ns instead of ~75ns per operation at 1M employees)
+
+// timed operations
+enum class QueueOp : uint8_t {
+    INSERT,       // insert/tryInsert
+    INSERT_BATCH, // insertBatch/tryInsertBatch, one sample per batch
+    REMOVE,
+    REMOVE_BATCH, // one sample per batch
+    EXTRACT_MAX,
+    PRINT,        // print/printRange
+    UPDATE,       // updateEmployee: re-indexing and moving the employee once the change is made
+    COUNT
+};
+
+// plain counters
+enum class QueueCounter : uint8_t {
+    PEEK,             // too cheap to time, only counted
+    SIFT_UP,          // calls
+    SIFT_UP_LEVELS,   // levels moved
+    SIFT_DOWN,
+    SIFT_DOWN_LEVELS,
+    COMPARISONS,      // salary comparisons inside the sifts
+    SCAN_SORT,        // sorted view rebuilt for print/export
+    SCAN_HEAPIFY,     // whole heap rebuilt (big batches, bulk updates)
+    SCAN_SALARY_INDEX,   // salary index built for a range/rank/percentile query
+    SCAN_PAYROLL_MINMAX, // payroll min/max rescanned after a removal took one of them
+    SCAN_COMPACT,        // tombstones dropped from the heap (big removeBatch, lazy removal)
+    COUNT
+};
+
+// log-linear latency buckets, like HdrHistogram with 3 significant bits: 8 buckets per power of two,
+// so any value lands in a bucket at most 12.5% wide. covers the whole uint64 range of nanoseconds
+const size_t LatencySubBucketBits = 3;
+const size_t LatencySubBuckets = size_t(1) << LatencySubBucketBits;
+const size_t LatencyBuckets = (64 - LatencySubBucketBits + 1) * LatencySubBuckets;
+
+inline size_t latencyBucket(uint64_t nanos) {
+    if (nanos < LatencySubBuckets) {
+        return static_cast<size_t>(nanos);
+    }
+    size_t exponent = 63 - __builtin_clzll(nanos); // >= LatencySubBucketBits here
+    size_t sub = static_cast<size_t>(nanos >> (exponent - LatencySubBucketBits)) & (LatencySubBuckets - 1);
+    return (exponent - LatencySubBucketBits + 1) * LatencySubBuckets + sub;
+}
+uint64_t latencyBucketUpperBound(size_t bucket); // biggest value that lands in it
+
+// the first operation of each kind on a thread is timed, then every 16th
+const uint64_t LatencySampleEvery = 16;
+
+const size_t QueueOpCount = static_cast<size_t>(QueueOp::COUNT);
+const size_t QueueCounterCount = static_cast<size_t>(QueueCounter::COUNT);
+
+// one thread's numbers. only its own thread writes, anyone may read
+struct ThreadMetrics {
+    atomic<uint64_t> counters[QueueCounterCount] = {};
+    atomic<uint64_t> operations[QueueOpCount] = {};
+    atomic<uint64_t> latencySum[QueueOpCount] = {}; // nanoseconds, timed operations only
+    atomic<uint64_t> latency[QueueOpCount][LatencyBuckets] = {};
+
+    static void add(atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+};
+
+// hands the calling thread a block, taken from the blocks of threads that have exited when there are any.
+// blocks are never freed, so what an exited thread counted is still in the totals
+class ThreadMetricsLease {
+private:
+    ThreadMetrics* block;
+public:
+    ThreadMetricsLease();
+    ~ThreadMetricsLease();
+    ThreadMetricsLease(const ThreadMetricsLease&) = delete;
+    ThreadMetricsLease& operator=(const ThreadMetricsLease&) = delete;
+    ThreadMetrics& metrics() { return *block; }
+};
+
+inline ThreadMetrics& threadMetrics() {
+    thread_local ThreadMetricsLease lease;
+    return lease.metrics();
+}
+
+inline void countMetric(QueueCounter counter, uint64_t n) {
+    ThreadMetrics::add(threadMetrics().counters[static_cast<size_t>(counter)], n);
+}
+
+// counts op, and times its scope into op's histogram if this one is a sample
+class OperationTimer {
+private:
+    ThreadMetrics& metrics;
+    size_t index;
+    bool sampled;
+    chrono::steady_clock::time_point start;
+public:
+    explicit OperationTimer(QueueOp op) : metrics(threadMetrics()), index(static_cast<size_t>(op)) {
+        uint64_t count = metrics.operations[index].load(memory_order_relaxed);
+        metrics.operations[index].store(count + 1, memory_order_relaxed);
+        sampled = count % LatencySampleEvery == 0;
+        if (sampled) {
+            start = chrono::steady_clock::now();
+        }
+    }
+    ~OperationTimer() {
+        if (!sampled) {
+            return;
+        }
+        uint64_t nanos = static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        ThreadMetrics::add(metrics.latencySum[index], nanos);
+        ThreadMetrics::add(metrics.latency[index][latencyBucket(nanos)], 1);
+    }
+    OperationTimer(const OperationTimer&) = delete;
+    OperationTimer& operator=(const OperationTimer&) = delete;
+};
+
+// the hooks the queue uses. switched off, a count still names its value so the locals it adds up
+// don't trip unused warnings, and the optimizer drops them
+#ifdef EMPLOYEE_METRICS
+#define EMPLOYEE_METRICS_TIME(op) OperationTimer operationTimer(op)
+#define EMPLOYEE_METRICS_COUNT(counter, n) countMetric(counter, n)
+#else
+#define EMPLOYEE_METRICS_TIME(op) ((void)0)
+#define EMPLOYEE_METRICS_COUNT(counter, n) ((void)(n))
+#endif
+
+// Prometheus text format: counters and latency summaries (p50/p90/p99/p999 from the sampled histograms, summed
+// over every thread, _count is the number of samples), then gauges for the queue's size and memory if one is given. with metrics compiled out only
+// the gauges are there. writeMetrics goes through a temp file and a rename, so a scraper never reads half a dump
+string formatMetrics(const EmployeePriorityQueue* queue);
+void writeMetrics(const string& path, const EmployeePriorityQueue* queue); // throws runtime_error if it can't
+
+#endif
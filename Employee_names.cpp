@@ -0,0 +1,141 @@
+#include "employee_names.h"
+using namespace std;
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+
+
+static uint32_t hashName(string_view name) {
+    uint64_t full = std::hash<string_view>()(name);
+    return static_cast<uint32_t>(full ^ (full >> 32));
+}
+
+// per thread, direct mapped by hash: names this thread interned lately. an entry is only trusted if its
+// generation is the arena's, so a destroyed arena's views (or a new arena at the same address) never match.
+// views never go stale while their arena lives, so a hit needs no lock
+namespace {
+
+struct RecentName {
+    uint64_t generation = 0; // 0 = empty, arenas start at 1
+    const char* data = nullptr;
+    uint32_t size = 0;
+    uint32_t hash = 0;
+};
+
+const size_t RecentNames = 256;
+thread_local RecentName recentNames[RecentNames];
+
+atomic<uint64_t> nextGeneration{1};
+
+} // namespace
+
+NameArena::NameArena() : generation(nextGeneration.fetch_add(1, memory_order_relaxed)) {}
+
+void NameArena::Shard::rehash(size_t bucketCount) {
+    vector<Bucket> old = move(buckets);
+    buckets.assign(bucketCount, Bucket{nullptr, 0, 0});
+    size_t mask = bucketCount - 1;
+    for (const Bucket& bucket : old) {
+        if (bucket.data) {
+            size_t i = bucket.hash & mask;
+            while (buckets[i].data) {
+                i = (i + 1) & mask;
+            }
+            buckets[i] = bucket;
+        }
+    }
+}
+
+void NameArena::reserve(size_t names) {
+    size_t perShard = names / ShardCount + names / (4 * ShardCount) + 16; //hashes don't split perfectly evenly
+    for (Shard& shard : shards) {
+        lock_guard<mutex> guard(shard.lock);
+        size_t bucketCount = shard.buckets.empty() ? 64 : shard.buckets.size();
+        while (bucketCount < perShard * 2) {
+            bucketCount *= 2;
+        }
+        if (bucketCount != shard.buckets.size()) {
+            shard.rehash(bucketCount);
+        }
+    }
+}
+
+// kept at most half full, so probes stay short
+string_view NameArena::Shard::intern(string_view name, uint32_t hash) {
+    if ((count + 1) * 2 > buckets.size()) {
+        rehash(buckets.empty() ? 64 : buckets.size() * 2);
+    }
+    size_t mask = buckets.size() - 1;
+    size_t i = hash & mask;
+    for (; buckets[i].data; i = (i + 1) & mask) {
+        const Bucket& bucket = buckets[i];
+        if (bucket.hash == hash && bucket.size == name.size() && memcmp(bucket.data, name.data(), name.size()) == 0) {
+            return string_view(bucket.data, bucket.size);
+        }
+    }
+
+    char* copy;
+    if (name.size() > ChunkSize) {
+        chunks.push_back(make_unique<char[]>(name.size()));
+        copy = chunks.back().get(); //current keeps pointing at the chunk small names go into
+    } else {
+        if (ChunkSize - chunkUsed < name.size()) {
+            chunks.push_back(make_unique<char[]>(ChunkSize));
+            current = chunks.back().get();
+            chunkUsed = 0;
+        }
+        copy = current + chunkUsed;
+        chunkUsed += name.size();
+    }
+    memcpy(copy, name.data(), name.size());
+    bytes += name.size();
+
+    buckets[i] = {copy, static_cast<uint32_t>(name.size()), hash};
+    count++;
+    return string_view(copy, name.size());
+}
+
+string_view NameArena::intern(string_view name) {
+    if (name.empty()) {
+        return string_view();
+    }
+    uint32_t hash = hashName(name);
+    RecentName& recent = recentNames[hash % RecentNames];
+    if (recent.generation == generation && recent.hash == hash && recent.size == name.size() &&
+        memcmp(recent.data, name.data(), name.size()) == 0) {
+        return string_view(recent.data, recent.size);
+    }
+
+    Shard& shard = shardFor(hash);
+    string_view stored;
+    {
+        lock_guard<mutex> guard(shard.lock);
+        stored = shard.intern(name, hash);
+    }
+    recent = {generation, stored.data(), static_cast<uint32_t>(stored.size()), hash};
+    return stored;
+}
+
+size_t NameArena::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        lock_guard<mutex> guard(shard.lock);
+        total += shard.count;
+    }
+    return total;
+}
+
+size_t NameArena::bytesUsed() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        lock_guard<mutex> guard(shard.lock);
+        total += shard.bytes;
+    }
+    return total;
+}
+
+NameArena& employeeNames() {
+    static NameArena* names = new NameArena(); //leaked on purpose, see the header
+    return *names;
+}
@@ -0,0 +1,69 @@
+#ifndef EMPLOYEE_NAMES_H
+#define EMPLOYEE_NAMES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// append only string arena with interning: every distinct name is stored once, in big chunks,
+// and handed out as a string_view that stays valid for as long as the arena lives.
+//
+// nothing is ever freed: memory follows the number of distinct names ever interned, not the number of
+// employees alive. that's what lets an Employee, a snapshot row or a reader's version keep a bare view
+// with no reference count. the catch is a long running process whose names keep changing (the queue
+// service's workers): it grows by every new name, about the name's length plus 16 bytes of set.
+// employee_name_arena_bytes in the metrics dump shows it; restarting the process is the way to give it back
+//
+// employees get built on many threads at once (import, the concurrent queue, producers), so the set is
+// split into shards by hash, each with its own lock, and each thread remembers the names it interned
+// recently: a repeat of one of those is found without taking any lock
+class NameArena {
+private:
+    static constexpr size_t ChunkSize = 64 * 1024; // longer names get a chunk of their own
+    static constexpr unsigned ShardBits = 4;       // shards are picked by the top bits of the hash
+    static constexpr size_t ShardCount = size_t(1) << ShardBits;
+
+    // flat open addressing set of views into the chunks, same idea as IdSlotMap. unordered_set allocated
+    // a node per name, which doubled the cost of importing a roster full of distinct names
+    struct Bucket {
+        const char* data; // nullptr = empty
+        uint32_t size;
+        uint32_t hash;    // low bits pick the bucket, all of it is compared before the text
+    };
+
+    struct Shard {
+        mutable mutex lock;
+        vector<unique_ptr<char[]>> chunks;
+        char* current = nullptr;      // chunk small names are going into
+        size_t chunkUsed = ChunkSize; // bytes taken in it, full means start a new one
+        size_t bytes = 0;
+        vector<Bucket> buckets; // size is always 0 or a power of two
+        size_t count = 0;
+
+        void rehash(size_t bucketCount);
+        string_view intern(string_view name, uint32_t hash); // lock must be held
+    };
+    Shard shards[ShardCount];
+    uint64_t generation; // tells this arena's entries apart in the per-thread caches
+
+    Shard& shardFor(uint32_t hash) { return shards[hash >> (32 - ShardBits)]; }
+
+public:
+    NameArena();
+    NameArena(const NameArena&) = delete;
+    NameArena& operator=(const NameArena&) = delete;
+
+    string_view intern(string_view name); // same text in, same view out. safe from any thread
+    void reserve(size_t names);           // room for this many distinct names without rehashing
+    size_t size() const;      // distinct names
+    size_t bytesUsed() const; // name bytes stored, not counting the set
+};
+
+// the arena every Employee name lives in. never destroyed, so names outlive any static Employee too
+NameArena& employeeNames();
+
+#endif
@@ -0,0 +1,151 @@
+#include "employee_pool.h"
+using namespace std;
+
+#include <new>
+#include <stdexcept>
+
+
+// handles from the pool go back to it, everything else was made with new
+void EmployeeDeleter::operator()(Employee* employee) const {
+    if (pool) {
+        pool->destroy(employee);
+    } else {
+        delete employee;
+    }
+}
+
+
+// block pool
+BlockPool::BlockPool(size_t objectSize) {
+    // round up so every block stays aligned, and big enough to hold the free list pointer
+    const size_t align = alignof(max_align_t);
+    blockSize = (max(objectSize, sizeof(void*)) + align - 1) / align * align;
+}
+
+BlockPool::~BlockPool() {
+    for (void* chunk : chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+BlockPool::BlockPool(BlockPool&& other) noexcept {
+    *this = move(other);
+}
+
+BlockPool& BlockPool::operator=(BlockPool&& other) noexcept {
+    if (this != &other) {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+        blockSize = other.blockSize;
+        nextChunkBlocks = other.nextChunkBlocks;
+        chunks = move(other.chunks);
+        freeList = other.freeList;
+        freeBlocks = other.freeBlocks;
+        liveBlocks = other.liveBlocks;
+        other.chunks.clear();
+        other.freeList = nullptr;
+        other.freeBlocks = 0;
+        other.liveBlocks = 0;
+    }
+    return *this;
+}
+
+// thread the new chunk's blocks onto the free list, in address order so allocations walk forward
+void BlockPool::addChunk(size_t blocks) {
+    char* chunk = static_cast<char*>(::operator new(blocks * blockSize));
+    chunks.push_back(chunk);
+    for (size_t i = blocks; i-- > 0;) {
+        void* block = chunk + i * blockSize;
+        *static_cast<void**>(block) = freeList;
+        freeList = block;
+    }
+    freeBlocks += blocks;
+}
+
+void* BlockPool::allocate() {
+    if (!freeList) {
+        addChunk(nextChunkBlocks);
+        nextChunkBlocks = min(nextChunkBlocks * 2, MaxChunkBlocks);
+    }
+    void* block = freeList;
+    freeList = *static_cast<void**>(block);
+    freeBlocks--;
+    liveBlocks++;
+    return block;
+}
+
+void BlockPool::deallocate(void* block) {
+    *static_cast<void**>(block) = freeList;
+    freeList = block;
+    freeBlocks++;
+    liveBlocks--;
+}
+
+void BlockPool::reserve(size_t blocks) {
+    if (freeBlocks < blocks) {
+        addChunk(blocks - freeBlocks);
+    }
+}
+
+
+// employee pool
+EmployeePool::EmployeePool() {
+    pools[static_cast<size_t>(EmployeeClass::CIO)] = BlockPool(sizeof(CIO));
+    pools[static_cast<size_t>(EmployeeClass::PM)] = BlockPool(sizeof(ProjectManager));
+    pools[static_cast<size_t>(EmployeeClass::BD)] = BlockPool(sizeof(BackendDeveloper));
+    pools[static_cast<size_t>(EmployeeClass::FD)] = BlockPool(sizeof(FrontendDeveloper));
+    pools[static_cast<size_t>(EmployeeClass::DB)] = BlockPool(sizeof(DatabaseEngineer));
+    pools[static_cast<size_t>(EmployeeClass::DE)] = BlockPool(sizeof(DevOpsEngineer));
+    pools[static_cast<size_t>(EmployeeClass::TST)] = BlockPool(sizeof(Tester));
+}
+
+EmployeeHandle EmployeePool::create(const EmployeeSpec& spec) {
+    string_view name = spec.name;
+    switch (spec.eClass) {
+        case EmployeeClass::CIO:
+            return create<CIO>(name, spec.id, spec.experience);
+        case EmployeeClass::PM:
+            return create<ProjectManager>(name, spec.id, spec.experience);
+        case EmployeeClass::BD:
+            return create<BackendDeveloper>(name, spec.id, spec.experience, spec.level,
+                                            static_cast<BackendTechnology>(spec.technology));
+        case EmployeeClass::FD:
+            return create<FrontendDeveloper>(name, spec.id, spec.experience, spec.level,
+                                             static_cast<FrontendTechnology>(spec.technology));
+        case EmployeeClass::DB:
+            return create<DatabaseEngineer>(name, spec.id, spec.experience, spec.level);
+        case EmployeeClass::DE:
+            return create<DevOpsEngineer>(name, spec.id, spec.experience, spec.level);
+        case EmployeeClass::TST:
+            return create<Tester>(name, spec.id, spec.experience, spec.level);
+    }
+    throw invalid_argument(employeeErrorMessage(EmployeeError::UNKNOWN_CLASS));
+}
+
+EmployeeResult EmployeePool::tryCreate(const EmployeeSpec& spec) {
+    EmployeeResult result;
+    result.error = validateEmployee(spec);
+    if (result.error == EmployeeError::NONE) {
+        result.employee = create(spec); //already validated, the constructor won't throw
+    }
+    return result;
+}
+
+// every concrete type has a fixed class, so the class tells us which pool the block came from
+void EmployeePool::destroy(Employee* employee) {
+    if (!employee) {
+        return;
+    }
+    BlockPool& pool = poolFor(employee->getEmployeeClass());
+    employee->~Employee(); //virtual, runs the right destructor
+    pool.deallocate(employee);
+}
+
+size_t EmployeePool::live() const {
+    size_t total = 0;
+    for (const BlockPool& pool : pools) {
+        total += pool.live();
+    }
+    return total;
+}
@@ -0,0 +1,101 @@
+#ifndef EMPLOYEE_POOL_H
+#define EMPLOYEE_POOL_H
+
+#include "employee_management.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// fixed size blocks carved out of big chunks. freed blocks go on a free list and get reused,
+// the chunks themselves are only given back when the pool is destroyed (all at once)
+class BlockPool {
+private:
+    size_t blockSize = 0;
+    size_t nextChunkBlocks = 64; // chunks double in size up to MaxChunkBlocks
+    vector<void*> chunks;
+    void* freeList = nullptr; // each free block stores the pointer to the next one
+    size_t freeBlocks = 0;
+    size_t liveBlocks = 0;
+
+    static constexpr size_t MaxChunkBlocks = 65536;
+    void addChunk(size_t blocks);
+
+public:
+    BlockPool() = default;
+    explicit BlockPool(size_t objectSize);
+    ~BlockPool();
+
+    void* allocate();
+    void deallocate(void* block);
+    void reserve(size_t blocks); // make sure this many more allocations won't touch malloc
+    size_t live() const { return liveBlocks; }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+    BlockPool(BlockPool&& other) noexcept;
+    BlockPool& operator=(BlockPool&& other) noexcept;
+};
+
+// expected-style result: the employee, or why there isn't one
+struct EmployeeResult {
+    EmployeeHandle employee;
+    EmployeeError error = EmployeeError::NONE;
+
+    explicit operator bool() const { return error == EmployeeError::NONE; }
+};
+
+// which block pool each concrete employee type lives in
+template<class T> struct EmployeePoolTag;
+template<> struct EmployeePoolTag<CIO> { static constexpr EmployeeClass value = EmployeeClass::CIO; };
+template<> struct EmployeePoolTag<ProjectManager> { static constexpr EmployeeClass value = EmployeeClass::PM; };
+template<> struct EmployeePoolTag<BackendDeveloper> { static constexpr EmployeeClass value = EmployeeClass::BD; };
+template<> struct EmployeePoolTag<FrontendDeveloper> { static constexpr EmployeeClass value = EmployeeClass::FD; };
+template<> struct EmployeePoolTag<DatabaseEngineer> { static constexpr EmployeeClass value = EmployeeClass::DB; };
+template<> struct EmployeePoolTag<DevOpsEngineer> { static constexpr EmployeeClass value = EmployeeClass::DE; };
+template<> struct EmployeePoolTag<Tester> { static constexpr EmployeeClass value = EmployeeClass::TST; };
+
+// one block pool per employee type, so same-type employees sit next to each other in memory
+// the pool has to outlive every handle it gives out (declare it before the queue). not thread safe
+class EmployeePool {
+private:
+    BlockPool pools[EmployeeClassCount];
+
+    BlockPool& poolFor(EmployeeClass eClass) { return pools[static_cast<size_t>(eClass)]; }
+
+public:
+    EmployeePool();
+
+    // construct any employee subclass in the pool, e.g. pool.create<CIO>("John Smith", 1001, 60)
+    template<class T, class... Args>
+    EmployeeHandle create(Args&&... args) {
+        BlockPool& pool = poolFor(EmployeePoolTag<T>::value);
+        void* block = pool.allocate();
+        try {
+            T* employee = new (block) T(forward<Args>(args)...);
+            return EmployeeHandle(employee, EmployeeDeleter{this});
+        }
+        catch (...) {
+            pool.deallocate(block); //constructor rejected the input, block goes straight back
+            throw;
+        }
+    }
+
+    // build whichever subclass the spec's class calls for. throws like the constructors do
+    EmployeeHandle create(const EmployeeSpec& spec);
+
+    // same, but validates first and reports an error code instead of throwing
+    EmployeeResult tryCreate(const EmployeeSpec& spec);
+
+    // pre-size before a bulk load so it's one allocation instead of many
+    template<class T>
+    void reserve(size_t count) { poolFor(EmployeePoolTag<T>::value).reserve(count); }
+
+    void destroy(Employee* employee); // used by EmployeeDeleter
+    size_t live() const;
+
+    EmployeePool(const EmployeePool&) = delete;
+    EmployeePool& operator=(const EmployeePool&) = delete;
+};
+
+#endif
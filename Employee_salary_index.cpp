@@ -0,0 +1,164 @@
+#include "employee_salary_index.h"
+using namespace std;
+
+
+// xorshift, plenty random for treap priorities and keeps the index deterministic run to run
+uint32_t SalaryIndex::nextPriority() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+void SalaryIndex::split(uint32_t node, double salary, int employeeId, uint32_t& less, uint32_t& rest) {
+    if (node == Nil) {
+        less = rest = Nil;
+        return;
+    }
+    if (keyLess(nodes[node].salary, nodes[node].employeeId, salary, employeeId)) {
+        split(nodes[node].right, salary, employeeId, nodes[node].right, rest);
+        less = node;
+    } else {
+        split(nodes[node].left, salary, employeeId, less, nodes[node].left);
+        rest = node;
+    }
+    update(node);
+}
+
+uint32_t SalaryIndex::merge(uint32_t less, uint32_t greater) {
+    if (less == Nil) {
+        return greater;
+    }
+    if (greater == Nil) {
+        return less;
+    }
+    if (nodes[less].priority > nodes[greater].priority) {
+        nodes[less].right = merge(nodes[less].right, greater);
+        update(less);
+        return less;
+    }
+    nodes[greater].left = merge(less, nodes[greater].left);
+    update(greater);
+    return greater;
+}
+
+void SalaryIndex::insert(double salary, int employeeId) {
+    uint32_t node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[node] = {salary, employeeId, nextPriority(), Nil, Nil, 1};
+
+    uint32_t less, rest;
+    split(root, salary, employeeId, less, rest);
+    root = merge(merge(less, node), rest);
+}
+
+bool SalaryIndex::erase(double salary, int employeeId) {
+    uint32_t probe = root;
+    while (probe != Nil && !(nodes[probe].salary == salary && nodes[probe].employeeId == employeeId)) {
+        probe = keyLess(salary, employeeId, nodes[probe].salary, nodes[probe].employeeId) ? nodes[probe].left : nodes[probe].right;
+    }
+    if (probe == Nil) {
+        return false;
+    }
+    // second walk shrinks every subtree on the way down, then unlinks the node
+    uint32_t* link = &root;
+    while (*link != Nil) {
+        Node& n = nodes[*link];
+        if (n.salary == salary && n.employeeId == employeeId) {
+            break;
+        }
+        n.size--;
+        link = keyLess(salary, employeeId, n.salary, n.employeeId) ? &n.left : &n.right;
+    }
+    uint32_t node = *link;
+    *link = merge(nodes[node].left, nodes[node].right);
+    freeNodes.push_back(node);
+    return true;
+}
+
+void SalaryIndex::clear() {
+    nodes.clear();
+    freeNodes.clear();
+    root = Nil;
+}
+
+// cartesian tree build with a stack: keys come in sorted, random priorities decide the shape
+void SalaryIndex::rebuild(const vector<pair<double, int>>& sortedKeys) {
+    clear();
+    nodes.reserve(sortedKeys.size());
+    vector<uint32_t> spine; // right spine of the tree built so far
+    for (const pair<double, int>& key : sortedKeys) {
+        uint32_t node = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({key.first, key.second, nextPriority(), Nil, Nil, 1});
+        uint32_t last = Nil;
+        while (!spine.empty() && nodes[spine.back()].priority < nodes[node].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        nodes[node].left = last;
+        if (!spine.empty()) {
+            nodes[spine.back()].right = node;
+        }
+        spine.push_back(node);
+    }
+    root = spine.empty() ? Nil : spine.front();
+
+    // sizes bottom up: children always come before parents in a post order walk
+    vector<pair<uint32_t, bool>> stack;
+    if (root != Nil) {
+        stack.push_back({root, false});
+    }
+    while (!stack.empty()) {
+        pair<uint32_t, bool> top = stack.back();
+        stack.pop_back();
+        if (top.second) {
+            update(top.first);
+            continue;
+        }
+        stack.push_back({top.first, true});
+        if (nodes[top.first].left != Nil) {
+            stack.push_back({nodes[top.first].left, false});
+        }
+        if (nodes[top.first].right != Nil) {
+            stack.push_back({nodes[top.first].right, false});
+        }
+    }
+}
+
+size_t SalaryIndex::countLess(double salary, int employeeId) const {
+    size_t count = 0;
+    uint32_t node = root;
+    while (node != Nil) {
+        const Node& n = nodes[node];
+        if (keyLess(n.salary, n.employeeId, salary, employeeId)) {
+            count += sizeOf(n.left) + 1;
+            node = n.right;
+        } else {
+            node = n.left;
+        }
+    }
+    return count;
+}
+
+pair<double, int> SalaryIndex::select(size_t k) const {
+    uint32_t node = root;
+    while (node != Nil) {
+        const Node& n = nodes[node];
+        size_t leftSize = sizeOf(n.left);
+        if (k < leftSize) {
+            node = n.left;
+        } else if (k == leftSize) {
+            return {n.salary, n.employeeId};
+        } else {
+            k -= leftSize + 1;
+            node = n.right;
+        }
+    }
+    return {0.0, 0}; //k out of range
+}
@@ -0,0 +1,75 @@
+#ifndef EMPLOYEE_SALARY_INDEX_H
+#define EMPLOYEE_SALARY_INDEX_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// ordered multiset of (salary, employee id) with subtree counts: a treap kept in one vector,
+// children are indexes instead of pointers. keys are ordered by salary, then id, ascending.
+// insert/erase/rank/select are O(log n) expected, a range costs O(log n + results)
+class SalaryIndex {
+private:
+    static constexpr uint32_t Nil = UINT32_MAX;
+
+    struct Node {
+        double salary;
+        int employeeId;
+        uint32_t priority; // random, parents have bigger priorities than children
+        uint32_t left;
+        uint32_t right;
+        uint32_t size;     // nodes in this subtree
+    };
+
+    vector<Node> nodes;
+    vector<uint32_t> freeNodes;
+    uint32_t root = Nil;
+    uint32_t rngState = 0x9E3779B9u;
+
+    static bool keyLess(double salaryA, int idA, double salaryB, int idB) {
+        return salaryA < salaryB || (salaryA == salaryB && idA < idB);
+    }
+    uint32_t nextPriority();
+    uint32_t sizeOf(uint32_t node) const { return node == Nil ? 0 : nodes[node].size; }
+    void update(uint32_t node) { nodes[node].size = 1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right); }
+    void split(uint32_t node, double salary, int employeeId, uint32_t& less, uint32_t& rest); // rest has keys >= given
+    uint32_t merge(uint32_t less, uint32_t greater);
+
+public:
+    void insert(double salary, int employeeId);
+    bool erase(double salary, int employeeId); // false if the key wasn't there
+    void clear();
+    size_t size() const { return sizeOf(root); }
+    size_t memoryBytes() const { return nodes.capacity() * sizeof(Node) + freeNodes.capacity() * sizeof(uint32_t); }
+
+    // replace everything with these keys in O(n). they must already be sorted ascending
+    void rebuild(const vector<pair<double, int>>& sortedKeys);
+
+    size_t countLess(double salary, int employeeId) const; // keys strictly below (salary, id)
+    pair<double, int> select(size_t k) const;              // k-th smallest key, 0 based, k < size()
+
+    // every key with lo <= salary <= hi, highest first
+    template<class Visit>
+    void forEachInRange(double lo, double hi, Visit visit) const { visitRange(root, lo, hi, visit); }
+
+private:
+    template<class Visit>
+    void visitRange(uint32_t node, double lo, double hi, Visit& visit) const {
+        if (node == Nil) {
+            return;
+        }
+        const Node& n = nodes[node];
+        if (n.salary <= hi) { //equal salaries can sit on either side
+            visitRange(n.right, lo, hi, visit);
+        }
+        if (lo <= n.salary && n.salary <= hi) {
+            visit(n.salary, n.employeeId);
+        }
+        if (lo <= n.salary) {
+            visitRange(n.left, lo, hi, visit);
+        }
+    }
+};
+
+#endif
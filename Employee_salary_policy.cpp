@@ -0,0 +1,94 @@
+#include "employee_salary_policy.h"
+using namespace std;
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+SalaryPolicy loadSalaryPolicy(const string& path, const SalaryPolicy& base) {
+    ifstream in(path);
+    if (!in) {
+        throw invalid_argument("can't open salary policy " + path);
+    }
+    return loadSalaryPolicy(in, path, base);
+}
+
+SalaryPolicy loadSalaryPolicy(istream& in, const string& source, const SalaryPolicy& base) {
+    SalaryPolicy policy = base;
+    string line;
+    for (size_t lineNumber = 1; getline(in, line); lineNumber++) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) {
+            line.erase(hash);
+        }
+        istringstream words(line);
+        string kind, name;
+        double value = 0.0;
+        if (!(words >> kind)) {
+            continue; //blank or comment only
+        }
+
+        auto fail = [&](const string& why) {
+            return invalid_argument(source + ":" + to_string(lineNumber) + ": " + why);
+        };
+        bool known = false;
+        if (kind == "experience") {
+            known = static_cast<bool>(words >> value);
+            policy.experienceBonusPerYear = value;
+        } else if (words >> name >> value) {
+            EmployeeClass eClass;
+            QualificationLevel level;
+            uint8_t tech = 0;
+            if (kind == "base" && parseEmployeeClass(name, eClass)) {
+                policy.baseSalary[static_cast<size_t>(eClass)] = value;
+                known = true;
+            } else if (kind == "multiplier" && parseQualificationLevel(name, level)) {
+                policy.qualificationMultiplier[static_cast<size_t>(level)] = value;
+                known = true;
+            } else if (kind == "backend" && parseTechnology(EmployeeClass::BD, name, tech)) {
+                policy.backendTechBonus[tech] = value;
+                known = true;
+            } else if (kind == "frontend" && parseTechnology(EmployeeClass::FD, name, tech)) {
+                policy.frontendTechBonus[tech] = value;
+                known = true;
+            }
+        }
+        string extra;
+        if (!known || words >> extra) {
+            throw fail("expected e.g. \"base CIO 15000\", got \"" + line + "\"");
+        }
+        if (kind == "experience" ? !validExperienceBonus(value) : !validSalaryRate(value)) {
+            throw fail(kind == "experience" ? "the experience bonus can't be negative"
+                                            : "rates have to be positive");
+        }
+    }
+    return policy;
+}
+
+void saveSalaryPolicy(const string& path, const SalaryPolicy& policy) {
+    ofstream out(path);
+    if (!out) {
+        throw invalid_argument("can't write salary policy " + path);
+    }
+    out.precision(17); //round trips exactly
+    for (size_t c = 0; c < EmployeeClassCount; c++) {
+        out << "base " << employeeClassName(static_cast<EmployeeClass>(c)) << ' ' << policy.baseSalary[c] << '\n';
+    }
+    for (size_t l = 0; l < QualificationLevelCount; l++) {
+        out << "multiplier " << qualificationLevelName(static_cast<QualificationLevel>(l)) << ' '
+            << policy.qualificationMultiplier[l] << '\n';
+    }
+    for (size_t t = 0; t < TechnologyCount; t++) {
+        out << "backend " << technologyName(EmployeeClass::BD, static_cast<uint8_t>(t)) << ' '
+            << policy.backendTechBonus[t] << '\n';
+    }
+    for (size_t t = 0; t < TechnologyCount; t++) {
+        out << "frontend " << technologyName(EmployeeClass::FD, static_cast<uint8_t>(t)) << ' '
+            << policy.frontendTechBonus[t] << '\n';
+    }
+    out << "experience " << policy.experienceBonusPerYear << '\n';
+    if (!out.flush()) {
+        throw runtime_error("can't write salary policy " + path);
+    }
+}
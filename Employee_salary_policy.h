@@ -0,0 +1,28 @@
+#ifndef EMPLOYEE_SALARY_POLICY_H
+#define EMPLOYEE_SALARY_POLICY_H
+
+#include "employee_management.h"
+#include <istream>
+#include <string>
+using namespace std;
+
+// salary policy files: one rate per line, anything not listed keeps the value from the base policy
+//
+//   # comment
+//   base CIO 16000
+//   multiplier SENIOR 2.2
+//   backend NET 1.2
+//   frontend REACT 1.2
+//   experience 0.08        (bonus per year)
+//
+// throws invalid_argument naming the file and line on anything it can't read, or on a rate setSalaryPolicy
+// would refuse (validSalaryRate / validExperienceBonus), so a policy that loads can always be applied
+SalaryPolicy loadSalaryPolicy(const string& path, const SalaryPolicy& base = DefaultSalaryPolicy);
+
+// same, from a stream. source names it in the error messages
+SalaryPolicy loadSalaryPolicy(istream& in, const string& source, const SalaryPolicy& base = DefaultSalaryPolicy);
+
+// writes every rate in the format above
+void saveSalaryPolicy(const string& path, const SalaryPolicy& policy);
+
+#endif
@@ -0,0 +1,939 @@
+#include "employee_service.h"
+#include "employee_pool.h"
+using namespace std;
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace {
+
+template<class T>
+void put(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+bool take(string_view& in, T& value) {
+    if (in.size() < sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+// the length goes in once the body is written
+size_t beginFrame(string& out) {
+    size_t start = out.size();
+    put<uint32_t>(out, 0);
+    return start;
+}
+
+void endFrame(string& out, size_t start) {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+    memcpy(&out[start], &length, sizeof(length));
+}
+
+void statusFrame(string& out, ServiceStatus status) {
+    size_t frame = beginFrame(out);
+    put(out, status);
+    endFrame(out, frame);
+}
+
+void putEmployee(string& out, int id, double salary, string_view name) {
+    put<int32_t>(out, id);
+    put<double>(out, salary);
+    put<uint16_t>(out, static_cast<uint16_t>(name.size()));
+    out.append(name.data(), name.size());
+}
+
+bool takeEmployee(string_view& in, ServiceEmployee& employee) {
+    int32_t id;
+    double salary;
+    uint16_t length;
+    if (!take(in, id) || !take(in, salary) || !take(in, length) || in.size() < length) {
+        return false;
+    }
+    employee.id = id;
+    employee.salary = salary;
+    employee.name.assign(in.data(), length);
+    in.remove_prefix(length);
+    return true;
+}
+
+struct ServiceRequest {
+    ServiceOp op = ServiceOp::SIZE;
+    EmployeeSpec spec; // INSERT (the name points into the frame), REMOVE (just the id)
+    uint32_t count = 0; // TOP
+};
+
+bool decodeRequest(string_view body, ServiceRequest& request) {
+    uint8_t op;
+    if (!take(body, op) || op > static_cast<uint8_t>(ServiceOp::SYNC)) {
+        return false;
+    }
+    request.op = static_cast<ServiceOp>(op);
+    switch (request.op) {
+        case ServiceOp::INSERT: {
+            int32_t id, experience;
+            uint8_t eClass, level, technology;
+            uint16_t length;
+            if (!take(body, id) || !take(body, eClass) || !take(body, experience) || !take(body, level) ||
+                !take(body, technology) || !take(body, length) || body.size() != length || length > MaxServiceName) {
+                return false; //a long name could push a TOP reply past MaxServiceFrame
+            }
+            // out of range enum values are left for validateEmployee to report
+            request.spec.id = id;
+            request.spec.eClass = static_cast<EmployeeClass>(eClass);
+            request.spec.experience = experience;
+            request.spec.level = static_cast<QualificationLevel>(level);
+            request.spec.technology = technology;
+            request.spec.name = body;
+            return true;
+        }
+        case ServiceOp::REMOVE: {
+            int32_t id;
+            if (!take(body, id)) {
+                return false;
+            }
+            request.spec.id = id;
+            break;
+        }
+        case ServiceOp::TOP:
+            if (!take(body, request.count)) {
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+    return body.empty();
+}
+
+void writeAll(int fd, string_view data) {
+    while (!data.empty()) {
+        ssize_t wrote = write(fd, data.data(), data.size());
+        if (wrote < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error("can't write to worker: " + string(strerror(errno)));
+        }
+        data.remove_prefix(static_cast<size_t>(wrote));
+    }
+}
+
+
+// ---- worker: one queue, requests in order, one reply per request ----
+
+void execute(const ServiceRequest& request, EmployeePriorityQueue& queue, EmployeePool& pool, string& out) {
+    size_t frame = beginFrame(out);
+    switch (request.op) {
+        case ServiceOp::INSERT: {
+            EmployeeResult created = pool.tryCreate(request.spec);
+            EmployeeError error = created ? queue.tryInsert(move(created.employee)) : created.error;
+            if (error == EmployeeError::NONE) {
+                put(out, ServiceStatus::OK);
+            } else {
+                put(out, ServiceStatus::REJECTED);
+                put(out, static_cast<uint8_t>(error));
+            }
+            break;
+        }
+        case ServiceOp::REMOVE:
+            if (queue.contains(request.spec.id)) {
+                queue.remove(request.spec.id);
+                put(out, ServiceStatus::OK);
+            } else {
+                put(out, ServiceStatus::NOT_FOUND);
+            }
+            break;
+        case ServiceOp::PEEK:
+            if (const Employee* top = queue.peek()) {
+                put(out, ServiceStatus::OK);
+                putEmployee(out, top->getEmployeeId(), top->getSalary(), top->getName());
+            } else {
+                put(out, ServiceStatus::EMPTY);
+            }
+            break;
+        case ServiceOp::EXTRACT_MAX:
+            if (EmployeeHandle top = queue.extractMax()) {
+                put(out, ServiceStatus::OK);
+                putEmployee(out, top->getEmployeeId(), top->getSalary(), top->getName());
+            } else {
+                put(out, ServiceStatus::EMPTY);
+            }
+            break;
+        case ServiceOp::TOP: {
+            vector<const Employee*> best = queue.topK(request.count);
+            put(out, ServiceStatus::OK);
+            put<uint32_t>(out, static_cast<uint32_t>(best.size()));
+            for (const Employee* employee : best) {
+                putEmployee(out, employee->getEmployeeId(), employee->getSalary(), employee->getName());
+            }
+            break;
+        }
+        case ServiceOp::SIZE:
+            put(out, ServiceStatus::OK);
+            put<uint64_t>(out, queue.size());
+            break;
+        case ServiceOp::SYNC: {
+            put(out, ServiceStatus::OK);
+            put<uint64_t>(out, queue.size());
+            const Employee* top = queue.peek();
+            put<uint8_t>(out, top ? 1 : 0);
+            if (top) {
+                putEmployee(out, top->getEmployeeId(), top->getSalary(), top->getName());
+            }
+            break;
+        }
+    }
+    endFrame(out, frame);
+}
+
+// answers whatever has arrived with one write, until the coordinator closes its end
+void runWorker(int fd) {
+    EmployeePool pool; //declared first so it outlives the queue
+    EmployeePriorityQueue queue;
+    string in, out;
+    char chunk[1 << 16];
+    while (true) {
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        in.append(chunk, static_cast<size_t>(got));
+
+        size_t used = 0;
+        string_view body;
+        while (size_t length = nextFrame(string_view(in).substr(used), body)) {
+            ServiceRequest request;
+            if (decodeRequest(body, request)) {
+                execute(request, queue, pool, out);
+            } else {
+                statusFrame(out, ServiceStatus::BAD_REQUEST);
+            }
+            used += length;
+        }
+        in.erase(0, used);
+        writeAll(fd, out);
+        out.clear();
+    }
+}
+
+
+// ---- coordinator ----
+
+volatile sig_atomic_t stopService = 0;
+
+void requestStop(int) {
+    stopService = 1;
+}
+
+const size_t ShardBatchBytes = 64 << 10; // flushed early past this, so neither side blocks on a full socket
+const size_t NoJob = SIZE_MAX;           // a worker reply the coordinator keeps for itself
+
+struct Shard {
+    int fd = -1;
+    pid_t pid = -1;
+    string out;             // the batch being built
+    vector<size_t> waiting; // job of each request in the batch, NoJob for the coordinator's own
+    vector<string> kept;    // bodies of the NoJob replies from the last flush
+    string in;
+    uint64_t size = 0;      // as of the last flush
+    bool hasHead = false;
+    ServiceEmployee head;
+    bool dead = false;      // the worker crashed or broke the protocol. its ids are UNAVAILABLE from then on
+};
+
+struct Connection {
+    int fd = -1;
+    string in;
+    string out;
+    bool closing = false; // peer is done (or broke the protocol), close once out is written
+    uint32_t watching = EPOLLIN | EPOLLRDHUP; // the epoll interest it's registered with
+};
+
+struct Job {
+    Connection* connection;
+    string_view frame; // into connection->in, untouched until the round is answered
+    string response;
+};
+
+class Coordinator {
+private:
+    string socketPath;
+    vector<Shard> shards;
+    int listenFd = -1;
+    int epollFd = -1;
+    unordered_map<int, unique_ptr<Connection>> connections;
+    vector<Job> jobs;
+
+    void startWorkers(size_t count);
+    void listen();
+    void acceptAll();
+    void readAvailable(Connection& connection);
+    void writeAvailable(Connection& connection);
+    void close(Connection& connection);
+
+    Shard& shardOf(int employeeId);
+    Shard* bestShard();
+    bool allShardsUp() const;
+    void markDead(Shard& shard, const string& why);
+    void readFrames(Shard& shard, size_t count, const function<void(string_view, string_view)>& answer);
+    void flush();
+    void answer(size_t job, const ServiceRequest& request);
+    void runRound(const vector<Connection*>& ready);
+
+public:
+    explicit Coordinator(const ServiceOptions& options);
+    ~Coordinator();
+    void run();
+};
+
+Coordinator::Coordinator(const ServiceOptions& options) : socketPath(options.socketPath) {
+    size_t workers = options.workers ? options.workers : max(1u, thread::hardware_concurrency());
+    //workers first, so they don't inherit the listening socket or the epoll fd
+    startWorkers(workers);
+    listen();
+}
+
+Coordinator::~Coordinator() {
+    for (auto& entry : connections) {
+        ::close(entry.first);
+    }
+    for (Shard& shard : shards) {
+        if (shard.fd >= 0) {
+            ::close(shard.fd); //the worker sees eof and exits
+        }
+    }
+    for (Shard& shard : shards) {
+        while (waitpid(shard.pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+}
+
+void Coordinator::startWorkers(size_t count) {
+    shards.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) {
+            shards.resize(i);
+            throw runtime_error("can't create worker socket: " + string(strerror(errno)));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            ::close(pair[0]);
+            ::close(pair[1]);
+            shards.resize(i);
+            throw runtime_error("can't start worker: " + string(strerror(errno)));
+        }
+        if (pid == 0) {
+            //ctrl-c reaches the whole process group, the coordinator decides when workers stop
+            signal(SIGINT, SIG_IGN);
+            signal(SIGTERM, SIG_IGN);
+            ::close(pair[0]);
+            for (size_t j = 0; j < i; j++) {
+                ::close(shards[j].fd);
+            }
+            try {
+                runWorker(pair[1]);
+            }
+            catch (...) {
+                _exit(1);
+            }
+            _exit(0);
+        }
+        ::close(pair[1]);
+        shards[i].fd = pair[0];
+        shards[i].pid = pid;
+    }
+}
+
+void Coordinator::listen() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("bad socket path: " + socketPath);
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    //a socket left behind by a server that died is in the way, anything else at the path isn't ours to remove
+    struct stat existing;
+    if (lstat(socketPath.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        unlink(socketPath.c_str());
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw runtime_error("can't create socket: " + string(strerror(errno)));
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        string reason = strerror(errno);
+        ::close(fd);
+        throw runtime_error("can't bind " + socketPath + ": " + reason);
+    }
+    listenFd = fd; //from here on the destructor removes the socket file
+    if (::listen(fd, SOMAXCONN) < 0) {
+        throw runtime_error("can't listen on " + socketPath + ": " + string(strerror(errno)));
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        throw runtime_error("can't create epoll: " + string(strerror(errno)));
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+        throw runtime_error("can't watch socket: " + string(strerror(errno)));
+    }
+}
+
+void Coordinator::acceptAll() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; //EAGAIN, or a client that gave up before we got to it
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        unique_ptr<Connection> connection(new Connection());
+        connection->fd = fd;
+        connections[fd] = move(connection);
+    }
+}
+
+void Coordinator::readAvailable(Connection& connection) {
+    char chunk[1 << 16];
+    while (!connection.closing) {
+        ssize_t got = read(connection.fd, chunk, sizeof(chunk));
+        if (got > 0) {
+            connection.in.append(chunk, static_cast<size_t>(got));
+        } else if (got < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                connection.closing = true;
+            }
+            return;
+        }
+    }
+}
+
+void Coordinator::writeAvailable(Connection& connection) {
+    size_t sent = 0;
+    while (sent < connection.out.size()) {
+        ssize_t wrote = send(connection.fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+        if (wrote < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection.out.clear(); //the client is gone, nobody will read the rest
+                connection.closing = true;
+                return;
+            }
+            break;
+        }
+        sent += static_cast<size_t>(wrote);
+    }
+    connection.out.erase(0, sent);
+
+    //a closing connection stops watching for input: a half closed peer stays readable (at eof) for good,
+    //and level triggered epoll would wake us for it on every wait while the last replies drain
+    uint32_t watching = connection.closing ? 0u : static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP);
+    if (!connection.out.empty()) {
+        watching |= EPOLLOUT;
+    }
+    if (watching != connection.watching) {
+        epoll_event event{};
+        event.events = watching;
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.watching = watching;
+    }
+}
+
+void Coordinator::close(Connection& connection) {
+    int fd = connection.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd); //connection is gone after this
+}
+
+// fibonacci hashing, so ids handed out in steps of the worker count still spread out
+Shard& Coordinator::shardOf(int employeeId) {
+    uint64_t mixed = static_cast<uint32_t>(employeeId) * 0x9E3779B97F4A7C15ull;
+    return shards[(mixed >> 32) % shards.size()];
+}
+
+bool Coordinator::allShardsUp() const {
+    return none_of(shards.begin(), shards.end(), [](const Shard& shard) {
+        return shard.dead;
+    });
+}
+
+// the rest of the service carries on. closing our end makes a worker that's merely confused exit too,
+// the destructor still reaps it
+void Coordinator::markDead(Shard& shard, const string& why) {
+    cerr << "worker " << shard.pid << " failed (" << why << "), its shard is unavailable from now on" << endl;
+    ::close(shard.fd);
+    shard.fd = -1;
+    shard.dead = true;
+    shard.out.clear();
+    shard.in.clear();
+    shard.kept.clear();
+    shard.size = 0;
+    shard.hasHead = false;
+}
+
+Shard* Coordinator::bestShard() {
+    Shard* best = nullptr;
+    for (Shard& shard : shards) {
+        if (shard.hasHead && (!best || shard.head.salary > best->head.salary)) {
+            best = &shard;
+        }
+    }
+    return best;
+}
+
+// answer(body, whole frame) for each of the next count replies, blocking until they're all in
+void Coordinator::readFrames(Shard& shard, size_t count, const function<void(string_view, string_view)>& answer) {
+    char chunk[1 << 16];
+    while (true) {
+        size_t used = 0;
+        string_view body;
+        while (count > 0) {
+            size_t length = nextFrame(string_view(shard.in).substr(used), body);
+            if (length == 0) {
+                break;
+            }
+            answer(body, string_view(shard.in).substr(used, length));
+            used += length;
+            count--;
+        }
+        shard.in.erase(0, used);
+        if (count == 0) {
+            return;
+        }
+        ssize_t got = read(shard.fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            throw runtime_error("it closed its socket");
+        }
+        shard.in.append(chunk, static_cast<size_t>(got));
+    }
+}
+
+// every shard with pending requests gets its batch plus a SYNC, one write each. the writes all go out
+// before any reply is read, so the workers run their batches at the same time.
+// a worker that fails to take its batch or answer it is marked dead, and every job it still owed gets
+// UNAVAILABLE. the replies that came before the failure stand
+void Coordinator::flush() {
+    for (Shard& shard : shards) {
+        if (!shard.waiting.empty() && !shard.dead) {
+            encodeRequest(shard.out, ServiceOp::SYNC);
+            try {
+                writeAll(shard.fd, shard.out);
+            }
+            catch (const runtime_error& e) {
+                markDead(shard, e.what());
+            }
+            shard.out.clear();
+        }
+    }
+    for (Shard& shard : shards) {
+        if (shard.waiting.empty()) {
+            continue;
+        }
+        shard.kept.clear();
+        size_t answered = 0;
+        if (!shard.dead) {
+            try {
+                readFrames(shard, shard.waiting.size() + 1, [&](string_view body, string_view frame) {
+                    if (answered < shard.waiting.size()) {
+                        size_t job = shard.waiting[answered];
+                        if (job == NoJob) {
+                            shard.kept.emplace_back(body);
+                        } else {
+                            jobs[job].response.assign(frame.data(), frame.size());
+                        }
+                    } else {
+                        ServiceStatus status;
+                        uint8_t hasHead = 0;
+                        if (!take(body, status) || !take(body, shard.size) || !take(body, hasHead) ||
+                            (hasHead && !takeEmployee(body, shard.head))) {
+                            throw runtime_error("malformed reply");
+                        }
+                        shard.hasHead = hasHead != 0;
+                    }
+                    answered++;
+                });
+            }
+            catch (const runtime_error& e) {
+                markDead(shard, e.what());
+            }
+        }
+        for (; answered < shard.waiting.size(); answered++) {
+            size_t job = shard.waiting[answered];
+            if (job != NoJob) {
+                jobs[job].response.clear();
+                statusFrame(jobs[job].response, ServiceStatus::UNAVAILABLE);
+            }
+        }
+        shard.waiting.clear();
+    }
+}
+
+// inserts and removes queue up per shard. the global ops need every shard current, so they flush first
+void Coordinator::answer(size_t job, const ServiceRequest& request) {
+    string& response = jobs[job].response;
+    switch (request.op) {
+        case ServiceOp::INSERT:
+        case ServiceOp::REMOVE: {
+            Shard& shard = shardOf(request.spec.id);
+            if (shard.dead) {
+                statusFrame(response, ServiceStatus::UNAVAILABLE);
+                break;
+            }
+            shard.out.append(jobs[job].frame.data(), jobs[job].frame.size());
+            shard.waiting.push_back(job);
+            if (shard.out.size() > ShardBatchBytes) {
+                flush();
+            }
+            break;
+        }
+        case ServiceOp::PEEK: {
+            flush();
+            if (!allShardsUp()) {
+                statusFrame(response, ServiceStatus::UNAVAILABLE);
+                break;
+            }
+            Shard* best = bestShard();
+            size_t frame = beginFrame(response);
+            if (best) {
+                put(response, ServiceStatus::OK);
+                putEmployee(response, best->head.id, best->head.salary, best->head.name);
+            } else {
+                put(response, ServiceStatus::EMPTY);
+            }
+            endFrame(response, frame);
+            break;
+        }
+        case ServiceOp::EXTRACT_MAX: {
+            flush();
+            if (!allShardsUp()) {
+                statusFrame(response, ServiceStatus::UNAVAILABLE);
+                break;
+            }
+            Shard* best = bestShard();
+            if (!best) {
+                statusFrame(response, ServiceStatus::EMPTY);
+                break;
+            }
+            //only the shard holding the global max is asked, and its SYNC brings back its next head
+            best->out.append(jobs[job].frame.data(), jobs[job].frame.size());
+            best->waiting.push_back(job);
+            flush();
+            break;
+        }
+        case ServiceOp::TOP: {
+            flush();
+            uint32_t k = min(request.count, MaxServiceTop);
+            for (Shard& shard : shards) {
+                if (shard.size > 0) {
+                    encodeTop(shard.out, static_cast<uint32_t>(min<uint64_t>(k, shard.size)));
+                    shard.waiting.push_back(NoJob);
+                }
+            }
+            flush();
+            if (!allShardsUp()) {
+                for (Shard& shard : shards) {
+                    shard.kept.clear();
+                }
+                statusFrame(response, ServiceStatus::UNAVAILABLE);
+                break;
+            }
+            vector<ServiceEmployee> merged;
+            for (Shard& shard : shards) {
+                for (const string& body : shard.kept) {
+                    ServiceResponse part;
+                    if (decodeResponse(ServiceOp::TOP, body, part)) {
+                        merged.insert(merged.end(), make_move_iterator(part.employees.begin()),
+                                      make_move_iterator(part.employees.end()));
+                    }
+                }
+                shard.kept.clear();
+            }
+            size_t count = min<size_t>(k, merged.size());
+            partial_sort(merged.begin(), merged.begin() + count, merged.end(),
+                         [](const ServiceEmployee& a, const ServiceEmployee& b) {
+                             return a.salary > b.salary;
+                         });
+            size_t frame = beginFrame(response);
+            put(response, ServiceStatus::OK);
+            put<uint32_t>(response, static_cast<uint32_t>(count));
+            for (size_t i = 0; i < count; i++) {
+                putEmployee(response, merged[i].id, merged[i].salary, merged[i].name);
+            }
+            endFrame(response, frame);
+            break;
+        }
+        case ServiceOp::SIZE: {
+            flush();
+            if (!allShardsUp()) {
+                statusFrame(response, ServiceStatus::UNAVAILABLE);
+                break;
+            }
+            uint64_t total = 0;
+            for (const Shard& shard : shards) {
+                total += shard.size;
+            }
+            size_t frame = beginFrame(response);
+            put(response, ServiceStatus::OK);
+            put<uint64_t>(response, total);
+            endFrame(response, frame);
+            break;
+        }
+        case ServiceOp::SYNC:
+            statusFrame(response, ServiceStatus::BAD_REQUEST); //not for clients
+            break;
+    }
+}
+
+// everything that's arrived on the ready connections is one round: requests run in arrival order
+// (connection by connection), every reply goes back in its connection's order
+void Coordinator::runRound(const vector<Connection*>& ready) {
+    jobs.clear();
+    vector<size_t> consumed(ready.size(), 0);
+    for (size_t c = 0; c < ready.size(); c++) {
+        Connection& connection = *ready[c];
+        string_view pending(connection.in);
+        string_view body;
+        try {
+            while (size_t length = nextFrame(pending.substr(consumed[c]), body)) {
+                jobs.push_back({&connection, pending.substr(consumed[c], length), string()});
+                consumed[c] += length;
+            }
+        }
+        catch (const runtime_error&) {
+            //an oversized frame: answer what came before it, then hang up
+            consumed[c] = connection.in.size();
+            connection.closing = true;
+        }
+    }
+
+    for (size_t job = 0; job < jobs.size(); job++) {
+        ServiceRequest request;
+        string_view frame = jobs[job].frame;
+        if (!decodeRequest(frame.substr(sizeof(uint32_t)), request)) {
+            statusFrame(jobs[job].response, ServiceStatus::BAD_REQUEST);
+            continue;
+        }
+        answer(job, request);
+    }
+    flush();
+
+    for (Job& job : jobs) {
+        job.connection->out += job.response;
+    }
+    for (size_t c = 0; c < ready.size(); c++) {
+        ready[c]->in.erase(0, consumed[c]);
+    }
+}
+
+void Coordinator::run() {
+    epoll_event events[64];
+    vector<Connection*> ready;
+    while (!stopService) {
+        int count = epoll_wait(epollFd, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error("epoll_wait failed: " + string(strerror(errno)));
+        }
+        ready.clear();
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptAll();
+                continue;
+            }
+            auto found = connections.find(fd);
+            if (found == connections.end()) {
+                continue;
+            }
+            Connection& connection = *found->second;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                readAvailable(connection);
+                ready.push_back(&connection);
+            } else if (events[i].events & EPOLLOUT) {
+                writeAvailable(connection);
+                if (connection.closing && connection.out.empty()) {
+                    close(connection);
+                }
+            }
+        }
+        if (ready.empty()) {
+            continue;
+        }
+        runRound(ready);
+        for (Connection* connection : ready) {
+            writeAvailable(*connection);
+            if (connection->closing && connection->out.empty()) {
+                close(*connection);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+void encodeInsert(string& out, const EmployeeSpec& spec) {
+    if (spec.name.size() > MaxServiceName) {
+        throw invalid_argument("name too long for a request");
+    }
+    size_t frame = beginFrame(out);
+    put(out, ServiceOp::INSERT);
+    put<int32_t>(out, spec.id);
+    put<uint8_t>(out, static_cast<uint8_t>(spec.eClass));
+    put<int32_t>(out, spec.experience);
+    put<uint8_t>(out, static_cast<uint8_t>(spec.level));
+    put<uint8_t>(out, spec.technology);
+    put<uint16_t>(out, static_cast<uint16_t>(spec.name.size()));
+    out.append(spec.name.data(), spec.name.size());
+    endFrame(out, frame);
+}
+
+void encodeRemove(string& out, int employeeId) {
+    size_t frame = beginFrame(out);
+    put(out, ServiceOp::REMOVE);
+    put<int32_t>(out, employeeId);
+    endFrame(out, frame);
+}
+
+void encodeTop(string& out, uint32_t k) {
+    size_t frame = beginFrame(out);
+    put(out, ServiceOp::TOP);
+    put<uint32_t>(out, k);
+    endFrame(out, frame);
+}
+
+void encodeRequest(string& out, ServiceOp op) {
+    size_t frame = beginFrame(out);
+    put(out, op);
+    endFrame(out, frame);
+}
+
+size_t nextFrame(string_view buffer, string_view& body) {
+    uint32_t length;
+    if (!take(buffer, length)) {
+        return 0;
+    }
+    if (length > MaxServiceFrame) {
+        throw runtime_error("frame of " + to_string(length) + " bytes is too big");
+    }
+    if (buffer.size() < length) {
+        return 0;
+    }
+    body = buffer.substr(0, length);
+    return sizeof(uint32_t) + length;
+}
+
+bool decodeResponse(ServiceOp op, string_view body, ServiceResponse& response) {
+    response = ServiceResponse();
+    if (!take(body, response.status)) {
+        return false;
+    }
+    if (response.status == ServiceStatus::REJECTED) {
+        uint8_t error;
+        if (!take(body, error)) {
+            return false;
+        }
+        response.error = static_cast<EmployeeError>(error);
+    } else if (response.status == ServiceStatus::OK) {
+        switch (op) {
+            case ServiceOp::PEEK:
+            case ServiceOp::EXTRACT_MAX:
+                response.employees.resize(1);
+                if (!takeEmployee(body, response.employees[0])) {
+                    return false;
+                }
+                break;
+            case ServiceOp::TOP: {
+                uint32_t count;
+                if (!take(body, count)) {
+                    return false;
+                }
+                response.employees.resize(min<size_t>(count, body.size())); //a lying count can't make us allocate much
+                for (ServiceEmployee& employee : response.employees) {
+                    if (!takeEmployee(body, employee)) {
+                        return false;
+                    }
+                }
+                if (response.employees.size() != count) {
+                    return false;
+                }
+                break;
+            }
+            case ServiceOp::SIZE:
+                if (!take(body, response.size)) {
+                    return false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return body.empty();
+}
+
+void runService(const ServiceOptions& options) {
+    stopService = 0;
+    struct sigaction action{};
+    action.sa_handler = requestStop; //no SA_RESTART, so epoll_wait comes back with EINTR
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN); //a worker that died shows up as a failed write, not a signal
+
+    Coordinator coordinator(options);
+    coordinator.run();
+}
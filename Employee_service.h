@@ -0,0 +1,100 @@
+#ifndef EMPLOYEE_SERVICE_H
+#define EMPLOYEE_SERVICE_H
+
+#include "employee_management.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// local queue service: a coordinator process listens on a unix domain socket and forks worker processes,
+// each owning one EmployeePriorityQueue for a shard of the id space (an id always goes to the same worker).
+//
+// wire format, native byte order since both ends are on the same machine. every message is a frame:
+// uint32 body length, then the body. a request body is a uint8 ServiceOp, then
+//   INSERT       int32 id, uint8 class, int32 experience, uint8 level, uint8 technology, uint16 name length, name
+//                (at most MaxServiceName bytes, a longer one is a BAD_REQUEST)
+//   REMOVE       int32 id
+//   TOP          uint32 k
+//   the rest     nothing
+// a response body is a uint8 ServiceStatus, then
+//   REJECTED     uint8 EmployeeError (insert only)
+//   PEEK / EXTRACT_MAX, if OK      one employee: int32 id, double salary, uint16 name length, name
+//   TOP, always OK                 uint32 count, then that many employees, highest salary first
+//   SIZE                           uint64 count
+//
+// clients can pipeline: send any number of frames without waiting, responses come back in the same order.
+// the coordinator reads everything that's arrived on every connection, sends each worker its inserts/removes
+// as one batch, and answers peek/extractMax/top from the shards' heads (every batch reply carries the
+// worker's current top employee), so a worker only sees a global query when it holds the answer.
+// a worker that crashes or sends a malformed reply takes only its own shard down: the coordinator logs it,
+// answers everything that shard still owed with UNAVAILABLE and keeps serving the other shards' ids.
+// its employees are lost, the shard isn't restarted
+enum class ServiceOp : uint8_t {
+    INSERT,
+    REMOVE,
+    PEEK,
+    EXTRACT_MAX,
+    TOP,
+    SIZE,
+    SYNC // coordinator -> worker only, ends a batch. answered with OK, uint64 size, uint8 1 + the top employee or 0
+};
+
+enum class ServiceStatus : uint8_t {
+    OK,
+    EMPTY,     // peek/extractMax on an empty queue
+    NOT_FOUND, // remove of an id that isn't there
+    REJECTED,  // insert failed, the EmployeeError follows
+    BAD_REQUEST,
+    UNAVAILABLE // the worker for that id's shard has died. peek/extractMax/top/size need every shard, so
+                // once any worker is gone they all get this
+};
+
+const size_t MaxServiceFrame = 1 << 20; // bigger frames close the connection
+const uint32_t MaxServiceTop = 10000;   // a bigger TOP k is cut down to this
+const size_t MaxServiceName = 80;       // longest name INSERT takes, so the biggest TOP reply fits in a frame
+
+// a TOP reply is status + count, then per employee id + salary + name length + the name. the worker's reply
+// to the coordinator and the coordinator's merged reply are both bounded by this
+static_assert(1 + 4 + MaxServiceTop * (4 + 8 + 2 + MaxServiceName) <= MaxServiceFrame,
+              "a full TOP reply has to fit in one frame");
+
+// one employee in a response
+struct ServiceEmployee {
+    int id = 0;
+    double salary = 0.0;
+    string name;
+};
+
+struct ServiceResponse {
+    ServiceStatus status = ServiceStatus::OK;
+    EmployeeError error = EmployeeError::NONE; // REJECTED
+    uint64_t size = 0;                         // SIZE
+    vector<ServiceEmployee> employees;         // PEEK/EXTRACT_MAX (one), TOP
+};
+
+// building requests, each appends one frame to out
+void encodeInsert(string& out, const EmployeeSpec& spec); // throws invalid_argument on a name over MaxServiceName
+void encodeRemove(string& out, int employeeId);
+void encodeTop(string& out, uint32_t k);
+void encodeRequest(string& out, ServiceOp op); // PEEK, EXTRACT_MAX, SIZE
+
+// the frame at the front of buffer: its body and its total length, or 0 while it's still incomplete.
+// throws runtime_error on a frame bigger than MaxServiceFrame
+size_t nextFrame(string_view buffer, string_view& body);
+
+// what op's response body says. false if it's malformed
+bool decodeResponse(ServiceOp op, string_view body, ServiceResponse& response);
+
+struct ServiceOptions {
+    string socketPath;
+    size_t workers = 0; // 0 = one per core
+};
+
+// runs the coordinator until SIGINT/SIGTERM, then stops the workers and removes the socket.
+// throws runtime_error if it can't start
+void runService(const ServiceOptions& options);
+
+#endif
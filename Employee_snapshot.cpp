@@ -0,0 +1,194 @@
+#include "employee_snapshot.h"
+using namespace std;
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// the rename is only durable once the directory entry is on disk too
+static bool syncParentDirectory(const string& path) {
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// written to path.tmp, fsynced, renamed over path and the directory fsynced, so a crash mid save never leaves
+// a half written snapshot, and once save returns the new snapshot survives a power cut (the journal relies
+// on that before it throws its records away). tombstones (lazy removal) aren't written, the records are always just the live employees in heap order
+void EmployeePriorityQueue::save(const string& path) const {
+    vector<SnapshotRecord> records(size());
+    string names;
+    size_t next = 0;
+    for (size_t i = 0; i < heap.size(); i++) {
+        if (isTombstone(heap[i])) {
+            continue;
+        }
+        EmployeeSpec spec = payload[heap[i].slot]->describe();
+        SnapshotRecord& record = records[next++];
+        memset(&record, 0, sizeof(record));
+        record.salary = heap[i].salary;
+        record.employeeId = spec.id;
+        record.experience = spec.experience;
+        record.nameOffset = static_cast<uint32_t>(names.size());
+        record.nameLength = static_cast<uint32_t>(spec.name.size());
+        record.employeeClass = static_cast<uint8_t>(spec.eClass);
+        record.level = static_cast<uint8_t>(spec.level);
+        record.technology = spec.technology;
+        names.append(spec.name);
+        if (names.size() > UINT32_MAX) {
+            throw runtime_error("too many name bytes for a snapshot");
+        }
+    }
+    // skipping tombstones pulled later entries up past their parents. a heapify of the records puts them
+    // back in heap order, same as compact() would, without touching the queue
+    if (tombstones > 0 && records.size() > 1) {
+        auto siftDown = [&](size_t pos) {
+            while (true) {
+                size_t first = pos * arity + 1;
+                if (first >= records.size()) {
+                    return;
+                }
+                size_t best = first;
+                for (size_t c = first + 1; c < min(first + arity, records.size()); c++) {
+                    if (records[c].salary > records[best].salary) {
+                        best = c;
+                    }
+                }
+                if (!(records[best].salary > records[pos].salary)) {
+                    return;
+                }
+                swap(records[pos], records[best]);
+                pos = best;
+            }
+        };
+        for (size_t pos = (records.size() - 2) / arity + 1; pos-- > 0;) {
+            siftDown(pos);
+        }
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+    header.version = SnapshotVersion;
+    header.arity = static_cast<uint32_t>(arity);
+    header.count = records.size();
+    header.recordsOffset = sizeof(SnapshotHeader);
+    header.namesOffset = header.recordsOffset + records.size() * sizeof(SnapshotRecord);
+    header.namesSize = names.size();
+
+    string tmpPath = path + ".tmp";
+    FILE* out = fopen(tmpPath.c_str(), "wb");
+    if (!out) {
+        throw runtime_error("can't write " + tmpPath);
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(records.data(), sizeof(SnapshotRecord), records.size(), out) == records.size() &&
+              fwrite(names.data(), 1, names.size(), out) == names.size();
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0; //the data has to be on disk before the rename
+    ok = (fclose(out) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ::remove(tmpPath.c_str()); //the C file remove, not the member
+        throw runtime_error("failed writing snapshot " + path);
+    }
+    if (!syncParentDirectory(path)) {
+        throw runtime_error("wrote snapshot " + path + " but couldn't sync its directory");
+    }
+}
+
+
+EmployeeSnapshot::EmployeeSnapshot(const string& path) : file(path) {
+    string_view data = file.contents();
+    if (data.size() < sizeof(SnapshotHeader)) {
+        throw runtime_error(path + " is too small to be a snapshot");
+    }
+    header = reinterpret_cast<const SnapshotHeader*>(data.data());
+    if (memcmp(header->magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+        throw runtime_error(path + " is not an employee snapshot");
+    }
+    if (header->version != SnapshotVersion) {
+        throw runtime_error(path + " has an unsupported snapshot version");
+    }
+    // only the section bounds are checked here, nameOf() checks each name when it's used.
+    // each check leans on the ones before it, so nothing below can overflow or reach past the mapping
+    if (header->recordsOffset != sizeof(SnapshotHeader) ||
+        header->count > (data.size() - header->recordsOffset) / sizeof(SnapshotRecord) ||
+        header->namesOffset != header->recordsOffset + header->count * sizeof(SnapshotRecord) ||
+        header->namesOffset > data.size() ||
+        header->namesSize > data.size() - header->namesOffset) {
+        throw runtime_error(path + " is truncated or corrupt");
+    }
+    records = reinterpret_cast<const SnapshotRecord*>(data.data() + header->recordsOffset);
+    names = data.data() + header->namesOffset;
+}
+
+const SnapshotRecord* EmployeeSnapshot::peek() const {
+    return header->count == 0 ? nullptr : &records[0];
+}
+
+string_view EmployeeSnapshot::nameOf(const SnapshotRecord& record) const {
+    if (static_cast<uint64_t>(record.nameOffset) + record.nameLength > header->namesSize) {
+        return string_view();
+    }
+    return string_view(names + record.nameOffset, record.nameLength);
+}
+
+EmployeeSpec EmployeeSnapshot::specOf(const SnapshotRecord& record) const {
+    EmployeeSpec spec;
+    spec.name = nameOf(record);
+    spec.id = record.employeeId;
+    spec.eClass = static_cast<EmployeeClass>(record.employeeClass);
+    spec.experience = record.experience;
+    spec.level = static_cast<QualificationLevel>(record.level);
+    spec.technology = record.technology;
+    return spec;
+}
+
+void EmployeeSnapshot::print() const {
+    if (header->count == 0) {
+        cout << "priority queue is empty" << endl;
+        return;
+    }
+
+    printEmployeeTableHeader();
+
+    // sort record indexes, the mapping itself is read only
+    vector<uint32_t> order(size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    sort(order.begin(), order.end(),
+        [this](uint32_t a, uint32_t b) {
+            return records[a].salary > records[b].salary;
+        });
+
+    for (uint32_t index : order) {
+        const SnapshotRecord& r = records[index];
+        printEmployeeRow(r.employeeId, nameOf(r), r.salary, r.experience);
+    }
+    cout << endl;
+}
+
+// records are already in heap order, so the batch insert's heapify barely moves anything.
+// bad records (a damaged file) are skipped instead of failing the whole restore
+void EmployeeSnapshot::restore(EmployeePriorityQueue& queue, EmployeePool& pool) const {
+    vector<EmployeeHandle> batch;
+    batch.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        EmployeeResult created = pool.tryCreate(specOf(records[i]));
+        if (created) {
+            batch.push_back(move(created.employee));
+        }
+    }
+    queue.tryInsertBatch(batch);
+}
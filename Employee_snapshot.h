@@ -0,0 +1,77 @@
+#ifndef EMPLOYEE_SNAPSHOT_H
+#define EMPLOYEE_SNAPSHOT_H
+
+#include "employee_management.h"
+#include "employee_import.h"
+#include "employee_pool.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+using namespace std;
+
+// snapshot file layout (host byte order):
+//   SnapshotHeader, 64 bytes
+//   SnapshotRecord[count], 32 bytes each, in heap order with the header's arity (record 0 is the max).
+//     only live employees, a queue in lazy removal mode has its tombstones left out
+//   name bytes, records point into them with offset + length
+const char SnapshotMagic[8] = {'E', 'M', 'P', 'Q', 'S', 'N', 'A', 'P'};
+const uint32_t SnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t arity;       // heap arity the records were laid out with
+    uint64_t count;
+    uint64_t recordsOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint8_t reserved[16];
+};
+
+struct SnapshotRecord {
+    double salary;
+    int32_t employeeId;
+    int32_t experience;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint8_t employeeClass; // EmployeeClass
+    uint8_t level;         // QualificationLevel
+    uint8_t technology;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(SnapshotRecord) == 32, "snapshot records must stay 32 bytes");
+
+// read only, memory mapped snapshot. opening only checks the header, so it's instant even for huge files;
+// records are paged in by the OS when something touches them
+class EmployeeSnapshot {
+private:
+    MappedFile file;
+    const SnapshotHeader* header = nullptr;
+    const SnapshotRecord* records = nullptr;
+    const char* names = nullptr;
+
+public:
+    explicit EmployeeSnapshot(const string& path); // throws runtime_error on a missing or malformed file
+    static unique_ptr<EmployeeSnapshot> open(const string& path) { return make_unique<EmployeeSnapshot>(path); }
+
+    size_t size() const { return static_cast<size_t>(header->count); }
+    bool isEmpty() const { return header->count == 0; }
+    size_t getArity() const { return header->arity; }
+
+    // same questions the queue answers, straight from the mapping
+    const SnapshotRecord* peek() const; // nullptr if empty
+    const SnapshotRecord& record(size_t index) const { return records[index]; } // heap order
+    string_view nameOf(const SnapshotRecord& record) const;
+    EmployeeSpec specOf(const SnapshotRecord& record) const; // name points into the mapping
+    void print() const;
+
+    // build real employees from the snapshot and load them into a queue (one batch insert)
+    void restore(EmployeePriorityQueue& queue, EmployeePool& pool) const;
+
+    EmployeeSnapshot(const EmployeeSnapshot&) = delete;
+    EmployeeSnapshot& operator=(const EmployeeSnapshot&) = delete;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "employee_table.h"
+using namespace std;
+
+#include <stdexcept>
+
+
+EmployeeTable::EmployeeTable(const SalaryPolicy& policy) {
+    setPolicy(policy);
+}
+
+void EmployeeTable::setPolicy(const SalaryPolicy& policy) {
+    for (size_t c = 0; c < EmployeeClassCount; c++) {
+        EmployeeClass eClass = static_cast<EmployeeClass>(c);
+        bool qualified = eClass != EmployeeClass::CIO && eClass != EmployeeClass::PM;
+
+        for (size_t l = 0; l < QualificationLevelCount; l++) {
+            // same product order as the overrides (base * multiplier first) so results match bit for bit
+            double multiplier = qualified ? policy.qualificationMultiplier[l] : 1.0;
+            rate[c * QualificationLevelCount + l] = policy.baseSalary[c] * multiplier;
+        }
+        for (size_t t = 0; t < TechnologyCount; t++) {
+            double bonus = 1.0;
+            if (eClass == EmployeeClass::BD) {
+                bonus = policy.backendTechBonus[t];
+            } else if (eClass == EmployeeClass::FD) {
+                bonus = policy.frontendTechBonus[t];
+            }
+            techBonus[c * TechnologyCount + t] = bonus;
+        }
+    }
+    experienceBonusPerYear = policy.experienceBonusPerYear;
+}
+
+void EmployeeTable::append(int id, EmployeeClass eClass, int experience,
+                           QualificationLevel level, uint8_t technology) {
+    //same checks as the Employee constructor
+    if (id <= 0) {
+        throw invalid_argument("Employee id cant be negative");
+    }
+    if (experience < 0) {
+        throw invalid_argument("experience cannot be negative");
+    }
+    if (static_cast<size_t>(eClass) >= EmployeeClassCount ||
+        static_cast<size_t>(level) >= QualificationLevelCount || technology >= TechnologyCount) {
+        throw invalid_argument("unknown class, level or technology");
+    }
+
+    size_t c = static_cast<size_t>(eClass);
+    ids.push_back(id);
+    classes.push_back(static_cast<uint8_t>(c));
+    levels.push_back(static_cast<uint8_t>(level));
+    technologies.push_back(technology);
+    experienceMonths.push_back(experience);
+    salaries.push_back(rate[c * QualificationLevelCount + static_cast<size_t>(level)] *
+                       (1.0 + (experience / 12.0) * experienceBonusPerYear) *
+                       techBonus[c * TechnologyCount + technology]);
+}
+
+void EmployeeTable::append(const Employee& employee) {
+    EmployeeSpec spec = employee.describe();
+    append(spec.id, spec.eClass, spec.experience, spec.level, spec.technology);
+}
+
+void EmployeeTable::reserve(size_t n) {
+    ids.reserve(n);
+    classes.reserve(n);
+    levels.reserve(n);
+    technologies.reserve(n);
+    experienceMonths.reserve(n);
+    salaries.reserve(n);
+}
+
+void EmployeeTable::clear() {
+    ids.clear();
+    classes.clear();
+    levels.clear();
+    technologies.clear();
+    experienceMonths.clear();
+    salaries.clear();
+}
+
+// salary = rate[class][level] * experience bonus * techBonus[class][tech]
+// table lookups instead of switches, so there is nothing to branch on and the loop vectorizes (gathers on AVX2)
+void EmployeeTable::recomputeSalaries() {
+    const size_t n = ids.size();
+    const uint8_t* cls = classes.data();
+    const uint8_t* lvl = levels.data();
+    const uint8_t* tech = technologies.data();
+    const int* months = experienceMonths.data();
+    double* out = salaries.data();
+    const double perYear = experienceBonusPerYear;
+
+    for (size_t i = 0; i < n; i++) {
+        double experienceBonus = 1.0 + (months[i] / 12.0) * perYear; // same as getExperienceBonus
+        out[i] = rate[cls[i] * QualificationLevelCount + lvl[i]] *
+                 experienceBonus *
+                 techBonus[cls[i] * TechnologyCount + tech[i]];
+    }
+}
+
+double EmployeeTable::totalPayroll() const {
+    double total = 0.0;
+    for (double salary : salaries) {
+        total += salary;
+    }
+    return total;
+}
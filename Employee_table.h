@@ -0,0 +1,54 @@
+#ifndef EMPLOYEE_TABLE_H
+#define EMPLOYEE_TABLE_H
+
+#include "employee_management.h"
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// columnar (struct of arrays) employee store
+// no objects and no virtual calls, so payroll for the whole table is one tight loop over plain arrays
+class EmployeeTable {
+private:
+    vector<int> ids;
+    vector<uint8_t> classes;     // EmployeeClass
+    vector<uint8_t> levels;      // QualificationLevel, JUNIOR for CIO/PM (their rate ignores it)
+    vector<uint8_t> technologies; // BackendTechnology for BD, FrontendTechnology for FD, 0 otherwise
+    vector<int> experienceMonths;
+    vector<double> salaries;
+
+    // lookup tables built from a salary policy, same rules calculateSalary uses
+    // rate = base * qualification multiplier, indexed [class][level]
+    // techBonus indexed [class][technology], 1.0 for roles without a tech bonus
+    double rate[EmployeeClassCount * QualificationLevelCount];
+    double techBonus[EmployeeClassCount * TechnologyCount];
+    double experienceBonusPerYear;
+
+public:
+    explicit EmployeeTable(const SalaryPolicy& policy = salaryPolicy());
+
+    // new rates for the lookup tables. salaries already in the table change on the next recomputeSalaries()
+    void setPolicy(const SalaryPolicy& policy);
+
+    // rows. salary is filled in right away, recomputeSalaries() redoes the whole column
+    void append(int id, EmployeeClass eClass, int experience,
+                QualificationLevel level = QualificationLevel::JUNIOR, uint8_t technology = 0);
+    void append(const Employee& employee);
+    void reserve(size_t n);
+    void clear();
+    size_t size() const { return ids.size(); }
+
+    // batch kernel: recompute every salary from the rate tables, branch free
+    void recomputeSalaries();
+    double totalPayroll() const;
+
+    // read only column access
+    const vector<int>& getIds() const { return ids; }
+    const vector<uint8_t>& getClasses() const { return classes; }
+    const vector<uint8_t>& getLevels() const { return levels; }
+    const vector<uint8_t>& getTechnologies() const { return technologies; }
+    const vector<int>& getExperienceMonths() const { return experienceMonths; }
+    const vector<double>& getSalaries() const { return salaries; }
+};
+
+#endif
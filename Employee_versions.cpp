@@ -0,0 +1,114 @@
+#include "employee_versions.h"
+using namespace std;
+
+#include <algorithm>
+#include <iostream>
+
+
+VersionedRows::VersionedRows() : live(make_shared<Table>()) {}
+
+// a use count of 1 can't go up under us: versions only ever copy the table pointer, under the lock we hold,
+// and only the writer copies chunk pointers (when it copies a table)
+EmployeeRow& VersionedRows::writableRow(uint32_t slot) {
+    if (live.use_count() > 1) {
+        live = make_shared<Table>(*live);
+    }
+    size_t index = slot / ChunkRows;
+    if (index >= live->chunks.size()) {
+        live->chunks.resize(index + 1);
+    }
+    shared_ptr<Chunk>& chunk = live->chunks[index];
+    if (!chunk) {
+        chunk = make_shared<Chunk>();
+    } else if (chunk.use_count() > 1) {
+        chunk = make_shared<Chunk>(*chunk);
+    }
+    return chunk->rows[slot % ChunkRows];
+}
+
+void VersionedRows::set(uint32_t slot, const Employee& employee) {
+    EmployeeRow row;
+    row.spec = employee.describe();
+    row.salary = employee.getSalary();
+
+    lock_guard<mutex> guard(lock);
+    EmployeeRow& target = writableRow(slot);
+    if (target.spec.id == 0) {
+        live->count++;
+    }
+    target = row;
+}
+
+void VersionedRows::clear(uint32_t slot) {
+    lock_guard<mutex> guard(lock);
+    size_t index = slot / ChunkRows;
+    if (index >= live->chunks.size() || !live->chunks[index] || live->chunks[index]->rows[slot % ChunkRows].spec.id == 0) {
+        return;
+    }
+    writableRow(slot) = EmployeeRow();
+    live->count--;
+}
+
+// built off to the side and swapped in, so versions taken meanwhile keep the old table
+void VersionedRows::reset(const vector<EmployeeHandle>& payload) {
+    shared_ptr<Table> table = make_shared<Table>();
+    table->chunks.resize((payload.size() + ChunkRows - 1) / ChunkRows);
+    for (shared_ptr<Chunk>& chunk : table->chunks) {
+        chunk = make_shared<Chunk>();
+    }
+    for (size_t slot = 0; slot < payload.size(); slot++) {
+        if (payload[slot]) {
+            EmployeeRow& row = table->chunks[slot / ChunkRows]->rows[slot % ChunkRows];
+            row.spec = payload[slot]->describe();
+            row.salary = payload[slot]->getSalary();
+            table->count++;
+        }
+    }
+    lock_guard<mutex> guard(lock);
+    live = move(table);
+}
+
+shared_ptr<const VersionedRows::Table> VersionedRows::current() const {
+    lock_guard<mutex> guard(lock);
+    return live;
+}
+
+
+vector<EmployeeRow> QueueVersion::sortedRows() const {
+    vector<EmployeeRow> rows;
+    rows.reserve(size());
+    forEach([&](const EmployeeRow& row) {
+        rows.push_back(row);
+    });
+    sort(rows.begin(), rows.end(), [](const EmployeeRow& a, const EmployeeRow& b) {
+        return a.salary > b.salary;
+    });
+    return rows;
+}
+
+PayrollAggregate QueueVersion::payroll() const {
+    PayrollAggregate total;
+    forEach([&](const EmployeeRow& row) {
+        if (total.headcount == 0) {
+            total.minSalary = total.maxSalary = row.salary;
+        }
+        total.headcount++;
+        total.totalSalary += row.salary;
+        total.minSalary = min(total.minSalary, row.salary);
+        total.maxSalary = max(total.maxSalary, row.salary);
+        total.histogram[salaryHistogramBucket(row.salary)]++;
+    });
+    return total;
+}
+
+void QueueVersion::print() const {
+    if (isEmpty()) {
+        cout << "priority queue is empty" << endl;
+        return;
+    }
+    printEmployeeTableHeader();
+    for (const EmployeeRow& row : sortedRows()) {
+        printEmployeeRow(row.spec.id, row.spec.name, row.salary, row.spec.experience);
+    }
+    cout << endl;
+}
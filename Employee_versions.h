@@ -0,0 +1,84 @@
+#ifndef EMPLOYEE_VERSIONS_H
+#define EMPLOYEE_VERSIONS_H
+
+#include "employee_management.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+// one employee as a report sees it. the name is a view into the name arena, which is never freed,
+// so a row stays printable however long a reader keeps it
+struct EmployeeRow {
+    EmployeeSpec spec; // spec.id == 0 marks an empty slot
+    double salary = 0.0;
+};
+
+// the rows of a queue by payload slot, as a two level persistent array: a table of shared chunks.
+// the live table is only written by the queue's own thread. a reader's version shares the table and chunks,
+// and the writer copies a table or chunk the first time it writes to one that a version still holds.
+// so after a snapshot the first write costs one table copy (one pointer per chunk) and every chunk
+// written again costs one chunk copy, and nothing is copied while nobody holds a version.
+// a version's memory goes away with its last handle (plain reference counts)
+class VersionedRows {
+public:
+    static constexpr size_t ChunkRows = 512; // 24KB of rows
+
+    struct Chunk {
+        EmployeeRow rows[ChunkRows];
+    };
+    struct Table {
+        vector<shared_ptr<Chunk>> chunks;
+        size_t count = 0; // rows in use
+    };
+
+private:
+    mutable mutex lock; // held to write the live table, and by readers just long enough to copy its pointer
+    shared_ptr<Table> live;
+
+    EmployeeRow& writableRow(uint32_t slot); // copies whatever a version still shares. lock must be held
+
+public:
+    VersionedRows();
+
+    void set(uint32_t slot, const Employee& employee); // insert or overwrite
+    void clear(uint32_t slot);
+    void reset(const vector<EmployeeHandle>& payload); // start over from the queue's slots, O(n)
+
+    shared_ptr<const Table> current() const; // O(1), safe from any thread
+};
+
+// a frozen copy of a queue's employees, from EmployeePriorityQueue::snapshot(). reading it never blocks the
+// queue's writer and never sees its later changes. cheap to copy, it's a reference to shared data.
+// rows come in slot order, which is no particular order
+class QueueVersion {
+private:
+    shared_ptr<const VersionedRows::Table> table;
+
+public:
+    QueueVersion() = default; // empty
+    explicit QueueVersion(shared_ptr<const VersionedRows::Table> table) : table(move(table)) {}
+
+    size_t size() const { return table ? table->count : 0; }
+    bool isEmpty() const { return size() == 0; }
+
+    template<class Visit>
+    void forEach(Visit visit) const { // visit(const EmployeeRow&)
+        if (!table) {
+            return;
+        }
+        for (const shared_ptr<VersionedRows::Chunk>& chunk : table->chunks) {
+            for (const EmployeeRow& row : chunk->rows) {
+                if (row.spec.id != 0) {
+                    visit(row);
+                }
+            }
+        }
+    }
+
+    vector<EmployeeRow> sortedRows() const; // highest salary first
+    PayrollAggregate payroll() const;
+    void print() const; // the same table EmployeePriorityQueue::print shows
+};
+
+#endif
@@ -0,0 +1,88 @@
+// throughput of the concurrent queue vs one queue behind one mutex, 1 to 32 threads
+// each thread alternates insert and extractMax on a prefilled queue
+//
+// build: g++ -std=c++17 -O2 -pthread bench_concurrent.cpp employee_management.cpp employee_names.cpp employee_salary_index.cpp employee_versions.cpp employee_pool.cpp employee_concurrent.cpp -o bench_concurrent
+// run:   ./bench_concurrent [max threads] [ops per thread]
+// output is csv: mode,threads,ops,seconds,ops_per_sec
+#include "employee_concurrent.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int PrefillCount = 100000;
+
+// every thread gets its own id range so inserts never collide
+int makeId(size_t thread, size_t i) {
+    return static_cast<int>(1000000 + thread * 20000000 + i);
+}
+
+EmployeeHandle makeEmployee(int id) {
+    return EmployeeHandle(new Tester("bench", id, id % 240, static_cast<QualificationLevel>(id % 3)));
+}
+
+// the "before": what callers had to do without a concurrent queue
+struct LockedQueue {
+    mutex lock;
+    EmployeePriorityQueue queue;
+
+    void insert(EmployeeHandle employee) {
+        lock_guard<mutex> guard(lock);
+        queue.insert(move(employee));
+    }
+    EmployeeHandle extractMax() {
+        lock_guard<mutex> guard(lock);
+        return queue.extractMax();
+    }
+};
+
+template<class Queue>
+double run(Queue& queue, size_t threads, size_t opsPerThread) {
+    for (int i = 1; i <= PrefillCount; i++) {
+        queue.insert(makeEmployee(i));
+    }
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, t, opsPerThread]() {
+            for (size_t i = 0; i < opsPerThread; i += 2) {
+                queue.insert(makeEmployee(makeId(t, i)));
+                queue.extractMax();
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? strtoul(argv[1], nullptr, 10) : 32;
+    size_t opsPerThread = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200000;
+
+    printf("mode,threads,ops,seconds,ops_per_sec\n");
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        size_t ops = threads * opsPerThread;
+        {
+            LockedQueue queue;
+            double seconds = run(queue, threads, opsPerThread);
+            printf("mutex,%zu,%zu,%.3f,%.0f\n", threads, ops, seconds, ops / seconds);
+        }
+        {
+            ConcurrentEmployeeQueue queue(0, false);
+            double seconds = run(queue, threads, opsPerThread);
+            printf("relaxed,%zu,%zu,%.3f,%.0f\n", threads, ops, seconds, ops / seconds);
+        }
+        {
+            ConcurrentEmployeeQueue queue(0, true);
+            double seconds = run(queue, threads, opsPerThread);
+            printf("strict,%zu,%zu,%.3f,%.0f\n", threads, ops, seconds, ops / seconds);
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+// single thread timings for EmployeePriorityQueue at 1K to 10M employees, on a synthetic roster
+// covering every class with realistic level/technology mixes
+//
+// build: g++ -std=c++17 -O2 -pthread bench_queue.cpp employee_management.cpp employee_names.cpp employee_salary_index.cpp employee_versions.cpp employee_pool.cpp -o bench_queue
+// run:   ./bench_queue [max employees] [seed]
+// output is csv: op,employees,ops,ns_per_op,allocs_per_op,peak_rss_kb
+// allocations are every operator new in the process. peak rss is the high water mark so far (sizes go up,
+// so it follows the biggest roster built yet)
+#include "employee_management.h"
+#include "employee_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+using namespace std;
+
+// count every allocation, relaxed is enough for a counter read between phases
+static atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // kilobytes on linux
+}
+
+// roughly what a mid sized software company looks like
+class RosterGenerator {
+private:
+    mt19937_64 rng;
+    discrete_distribution<int> classes{1, 40, 250, 220, 80, 90, 160};     // CIO PM BD FD DB DE TST (per mille)
+    discrete_distribution<int> levels{45, 35, 20};                        // JUNIOR MIDDLE SENIOR
+    discrete_distribution<int> backendTech{25, 50, 25};                   // NET SPRING DJANGO
+    discrete_distribution<int> frontendTech{30, 50, 20};                  // ANGULAR REACT VUE
+    geometric_distribution<int> experience{1.0 / 40};                     // months, mean ~3 years
+    vector<string> names;
+
+public:
+    explicit RosterGenerator(uint64_t seed) : rng(seed) {
+        const char* first[] = {"Nino", "Giorgi", "Ana", "Luka", "Mariam", "David", "Elene", "Sandro"};
+        const char* last[] = {"Beridze", "Kapanadze", "Gelashvili", "Lomidze", "Tsiklauri", "Mchedlishvili"};
+        for (const char* f : first) {
+            for (const char* l : last) {
+                names.push_back(string(f) + " " + l);
+            }
+        }
+    }
+
+    // the spec's name points into the generator
+    EmployeeSpec next(int id) {
+        EmployeeSpec spec;
+        spec.id = id;
+        spec.name = names[rng() % names.size()];
+        spec.eClass = static_cast<EmployeeClass>(classes(rng));
+        spec.experience = min(experience(rng), 480);
+        spec.level = static_cast<QualificationLevel>(levels(rng));
+        if (spec.eClass == EmployeeClass::BD) {
+            spec.technology = static_cast<uint8_t>(backendTech(rng));
+        } else if (spec.eClass == EmployeeClass::FD) {
+            spec.technology = static_cast<uint8_t>(frontendTech(rng));
+        }
+        return spec;
+    }
+};
+
+struct Phase {
+    const char* op;
+    size_t employees;
+    chrono::steady_clock::time_point start;
+    size_t allocationsAtStart;
+
+    Phase(const char* op, size_t employees)
+        : op(op), employees(employees), start(chrono::steady_clock::now()),
+          allocationsAtStart(allocations.load(memory_order_relaxed)) {}
+
+    void done(size_t ops) const {
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        size_t allocated = allocations.load(memory_order_relaxed) - allocationsAtStart;
+        printf("%s,%zu,%zu,%.1f,%.3f,%ld\n", op, employees, ops, ns / max<size_t>(ops, 1),
+               static_cast<double>(allocated) / max<size_t>(ops, 1), peakRssKb());
+        fflush(stdout);
+    }
+};
+
+// print() goes to cout, this swallows it so only formatting is measured
+struct NullBuffer : streambuf {
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+void runSize(size_t n, uint64_t seed) {
+    RosterGenerator generator(seed);
+    vector<EmployeeSpec> specs;
+    specs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        specs.push_back(generator.next(static_cast<int>(i + 1)));
+    }
+    const size_t sampled = min<size_t>(n, 1000000); // ops for the phases that don't need to touch everyone
+    mt19937_64 rng(seed + 1);
+
+    EmployeePool pool;
+    vector<EmployeeHandle> handles;
+    handles.reserve(n);
+    {
+        Phase phase("construct", n); // pool allocation + constructor + calculateSalary
+        for (const EmployeeSpec& spec : specs) {
+            handles.push_back(pool.create(spec));
+        }
+        phase.done(n);
+    }
+
+    EmployeePriorityQueue queue;
+    {
+        Phase phase("insert", n);
+        for (EmployeeHandle& employee : handles) {
+            queue.insert(move(employee));
+        }
+        phase.done(n);
+    }
+    {
+        Phase phase("peek", n);
+        double sum = 0.0;
+        for (size_t i = 0; i < sampled; i++) {
+            sum += queue.peek()->getSalary();
+        }
+        phase.done(sampled);
+        if (sum < 0) {
+            printf("# impossible\n"); //keeps the loop from being optimized out
+        }
+    }
+    {
+        NullBuffer sink;
+        streambuf* old = cout.rdbuf(&sink);
+        Phase phase("print", n);
+        queue.printRange(0, sampled); // includes the sort the first report after a change does
+        phase.done(sampled);
+        cout.rdbuf(old);
+    }
+    {
+        vector<int> ids(n);
+        for (size_t i = 0; i < n; i++) {
+            ids[i] = static_cast<int>(i + 1);
+        }
+        shuffle(ids.begin(), ids.end(), rng);
+        ids.resize(sampled / 2);
+        Phase phase("remove", n);
+        for (int id : ids) {
+            queue.remove(id);
+        }
+        phase.done(ids.size());
+    }
+    {
+        size_t count = min(sampled / 2, queue.size());
+        Phase phase("extractMax", n);
+        for (size_t i = 0; i < count; i++) {
+            queue.extractMax(); //handle goes straight back to the pool
+        }
+        phase.done(count);
+    }
+
+    // bulk loading for comparison with one by one inserts
+    handles.clear();
+    for (const EmployeeSpec& spec : specs) {
+        handles.push_back(pool.create(spec));
+    }
+    EmployeePriorityQueue batched;
+    {
+        Phase phase("insertBatch", n);
+        batched.insertBatch(move(handles));
+        phase.done(n);
+    }
+    // a layoff: a quarter of everyone in one call, for comparison with the remove phase
+    {
+        vector<int> ids(n);
+        for (size_t i = 0; i < n; i++) {
+            ids[i] = static_cast<int>(i + 1);
+        }
+        shuffle(ids.begin(), ids.end(), rng);
+        ids.resize(n / 4);
+        Phase phase("removeBatch", n);
+        batched.removeBatch(ids);
+        phase.done(ids.size());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxEmployees = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 42;
+
+    printf("op,employees,ops,ns_per_op,allocs_per_op,peak_rss_kb\n");
+    for (size_t n = 1000; n <= maxEmployees; n *= 10) {
+        runSize(n, seed);
+    }
+    return 0;
+}
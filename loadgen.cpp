@@ -0,0 +1,197 @@
+// load generator for the queue service (main --serve): requests per second and latency on one machine
+// each client is a thread with its own connection that keeps [depth] requests in flight. the mix is
+// 50% insert (fresh ids), 25% extractMax, 15% peek, 10% remove of an id that client inserted earlier
+//
+// build: g++ -std=c++17 -O2 -pthread loadgen.cpp employee_service.cpp employee_management.cpp employee_names.cpp employee_salary_index.cpp employee_versions.cpp employee_pool.cpp -o loadgen
+// run:   ./employee_system --serve /tmp/employees.sock 4 &
+//        ./loadgen /tmp/employees.sock [clients] [depth] [seconds]
+// output is csv: clients,depth,requests,seconds,requests_per_s,p50_us,p99_us
+// latency is from the request being written to its reply being read, so with depth > 1 it includes the
+// wait behind the requests ahead of it
+#include "employee_service.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct ClientResult {
+    size_t requests = 0;
+    size_t failed = 0; // replies that didn't decode, BAD_REQUEST or UNAVAILABLE
+    vector<uint32_t> latencyNs;
+};
+
+int connectTo(const string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("socket path too long");
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        throw runtime_error("can't connect to " + path + ": " + strerror(errno));
+    }
+    return fd;
+}
+
+void runClient(const string& path, size_t client, size_t clients, size_t depth, Clock::time_point stop,
+               ClientResult& result) {
+    int fd = connectTo(path);
+    mt19937 random(static_cast<unsigned>(client + 1));
+    uniform_int_distribution<int> percent(0, 99);
+    vector<int> inserted;
+    size_t nextId = 0;
+
+    struct Pending {
+        ServiceOp op;
+        Clock::time_point sent;
+    };
+    deque<Pending> inflight;
+    string out, in;
+    char chunk[1 << 16];
+
+    while (true) {
+        bool running = Clock::now() < stop;
+        if (running) {
+            Clock::time_point now = Clock::now();
+            while (inflight.size() < depth) {
+                int roll = percent(random);
+                ServiceOp op;
+                if (roll < 50 || (roll >= 90 && inserted.empty())) {
+                    EmployeeSpec spec;
+                    spec.name = "Load Test";
+                    spec.id = static_cast<int>(1 + nextId++ * clients + client); // no two clients share an id
+                    spec.eClass = static_cast<EmployeeClass>(2 + spec.id % 5);     // the five classes with many people
+                    spec.experience = spec.id % 240;
+                    spec.level = static_cast<QualificationLevel>(spec.id % 3);
+                    spec.technology = static_cast<uint8_t>(spec.id % 3);
+                    encodeInsert(out, spec);
+                    inserted.push_back(spec.id);
+                    op = ServiceOp::INSERT;
+                } else if (roll < 75) {
+                    encodeRequest(out, ServiceOp::EXTRACT_MAX);
+                    op = ServiceOp::EXTRACT_MAX;
+                } else if (roll < 90) {
+                    encodeRequest(out, ServiceOp::PEEK);
+                    op = ServiceOp::PEEK;
+                } else {
+                    size_t pick = random() % inserted.size();
+                    encodeRemove(out, inserted[pick]); // may have been extracted already, that's a NOT_FOUND
+                    inserted[pick] = inserted.back();
+                    inserted.pop_back();
+                    op = ServiceOp::REMOVE;
+                }
+                inflight.push_back({op, now});
+            }
+            for (size_t sent = 0; sent < out.size();) {
+                ssize_t wrote = write(fd, out.data() + sent, out.size() - sent);
+                if (wrote <= 0) {
+                    throw runtime_error("lost the server");
+                }
+                sent += static_cast<size_t>(wrote);
+            }
+            out.clear();
+        }
+        if (inflight.empty()) {
+            break;
+        }
+
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got <= 0) {
+            throw runtime_error("lost the server");
+        }
+        in.append(chunk, static_cast<size_t>(got));
+        Clock::time_point now = Clock::now();
+        size_t used = 0;
+        string_view body;
+        while (size_t length = nextFrame(string_view(in).substr(used), body)) {
+            ServiceResponse response;
+            if (!decodeResponse(inflight.front().op, body, response) || response.status == ServiceStatus::BAD_REQUEST ||
+                response.status == ServiceStatus::UNAVAILABLE) {
+                result.failed++;
+            }
+            result.latencyNs.push_back(static_cast<uint32_t>(
+                min<long long>(chrono::duration_cast<chrono::nanoseconds>(now - inflight.front().sent).count(), UINT32_MAX)));
+            result.requests++;
+            inflight.pop_front();
+            used += length;
+        }
+        in.erase(0, used);
+    }
+    close(fd);
+}
+
+double percentileUs(vector<uint32_t>& latencies, double p) {
+    if (latencies.empty()) {
+        return 0.0;
+    }
+    size_t rank = min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+    nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return latencies[rank] / 1000.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "usage: loadgen <socket> [clients] [depth] [seconds]\n";
+        return 1;
+    }
+    string path = argv[1];
+    size_t clients = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4;
+    size_t depth = argc > 3 ? strtoul(argv[3], nullptr, 10) : 32;
+    double seconds = argc > 4 ? atof(argv[4]) : 5.0;
+    if (clients == 0 || depth == 0 || seconds <= 0) {
+        cerr << "clients, depth and seconds have to be positive\n";
+        return 1;
+    }
+
+    vector<ClientResult> results(clients);
+    vector<thread> threads;
+    vector<string> errors(clients);
+    Clock::time_point start = Clock::now();
+    Clock::time_point stop = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+    for (size_t i = 0; i < clients; i++) {
+        threads.emplace_back([&, i] {
+            try {
+                runClient(path, i, clients, depth, stop, results[i]);
+            }
+            catch (const exception& e) {
+                errors[i] = e.what();
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    ClientResult total;
+    for (size_t i = 0; i < clients; i++) {
+        if (!errors[i].empty()) {
+            cerr << "client " << i << ": " << errors[i] << endl;
+            return 1;
+        }
+        total.requests += results[i].requests;
+        total.failed += results[i].failed;
+        total.latencyNs.insert(total.latencyNs.end(), results[i].latencyNs.begin(), results[i].latencyNs.end());
+    }
+    if (total.failed > 0) {
+        cerr << total.failed << " replies were malformed, rejected as bad requests or unavailable\n";
+    }
+    printf("clients,depth,requests,seconds,requests_per_s,p50_us,p99_us\n");
+    printf("%zu,%zu,%zu,%.3f,%.0f,%.1f,%.1f\n", clients, depth, total.requests, elapsed, total.requests / elapsed,
+           percentileUs(total.latencyNs, 0.50), percentileUs(total.latencyNs, 0.99));
+    return total.failed == 0 ? 0 : 2;
+}
@@ -1,7 +1,19 @@
 #include "employee_management.h"
+#include "employee_pool.h"
+#include "employee_batch.h"
+#include "employee_import.h"
+#include "employee_service.h"
+#include "employee_salary_policy.h"
+#include "employee_snapshot.h"
 #include <iostream>
 #include <iomanip>
+#include <cstddef>
+#include <cstdlib>
 #include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 
 // function to help validating
@@ -14,12 +26,26 @@ T getValidInput(const string& prompt) {
             cin.ignore(numeric_limits<streamsize>::max(), '\n');
             return value;
         }
+        if (cin.eof()) {
+            throw runtime_error("input ended before the answer"); //asking again would loop forever
+        }
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         cout << "invalid input, try again\n";
     }
 }
 
+// same, for a numbered menu: keeps asking until the answer is one of 0..count-1
+int getValidChoice(const string& prompt, int count) {
+    while (true) {
+        int choice = getValidInput<int>(prompt);
+        if (choice >= 0 && choice < count) {
+            return choice;
+        }
+        cout << "no such option, try again\n";
+    }
+}
+
 // helper function for displaying
 void printEmployeeDetails(const Employee* emp) {
     cout << "\nEmployee details:"
@@ -30,8 +56,57 @@ void printEmployeeDetails(const Employee* emp) {
               << endl;
 }
 
-int main() {
+// --batch [file]: run a command script (see employee_batch.h) instead of the demo. stdin if there's no file
+int runBatchMode(const char* path) {
+    EmployeePool pool;
+    EmployeePriorityQueue employeeQueue;
+    ExportWriter out(STDOUT_FILENO);
+    BatchReport report;
+    if (path) {
+        MappedFile script(path);
+        report = runBatch(script.contents(), employeeQueue, pool, out);
+    } else {
+        string script;
+        char chunk[1 << 16];
+        ssize_t got;
+        while ((got = read(STDIN_FILENO, chunk, sizeof(chunk))) > 0) {
+            script.append(chunk, static_cast<size_t>(got));
+        }
+        report = runBatch(script, employeeQueue, pool, out);
+    }
+    out.flush();
+    cerr << report.commands << " commands, " << report.failed << " failed, "
+         << fixed << setprecision(3) << report.seconds << " s\n";
+    return report.failed == 0 ? 0 : 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--batch") {
+        try {
+            return runBatchMode(argc > 2 ? argv[2] : nullptr);
+        }
+        catch (const exception& e) {
+            cerr << "batch failed: " << e.what() << endl;
+            return 1;
+        }
+    }
+    // --serve <socket> [workers]: run the queue service (see employee_service.h) until ctrl-c
+    if (argc > 2 && string_view(argv[1]) == "--serve") {
+        try {
+            ServiceOptions options;
+            options.socketPath = argv[2];
+            options.workers = argc > 3 ? stoul(argv[3]) : 0;
+            runService(options);
+            return 0;
+        }
+        catch (const exception& e) {
+            cerr << "service failed: " << e.what() << endl;
+            return 1;
+        }
+    }
+
     try {
+        EmployeePool pool; //declared first so it outlives the queue that holds its employees
         EmployeePriorityQueue employeeQueue;
 
         cout << "--testing begins--\n";
@@ -39,89 +114,89 @@ int main() {
 
         // 1: Cio
         cout << "1: Creating and adding CIO\n";
-        CIO* cio = new CIO("John Smith", 1001, 60);
-        printEmployeeDetails(cio);
-        employeeQueue.insert(cio);
+        EmployeeHandle cio = pool.create<CIO>("John Smith", 1001, 60);
+        printEmployeeDetails(cio.get());
+        employeeQueue.insert(move(cio));
         cout << "\npriority queue after 1:\n";
         employeeQueue.print();
 
         // 2: PM
         cout << "\n2: Creating and adding PM\n";
-        ProjectManager* pm = new ProjectManager("Jane Doe", 1002, 48);
-        printEmployeeDetails(pm);
-        employeeQueue.insert(pm);
+        EmployeeHandle pm = pool.create<ProjectManager>("Jane Doe", 1002, 48);
+        printEmployeeDetails(pm.get());
+        employeeQueue.insert(move(pm));
         cout << "\npriority queue after step 2:\n";
         employeeQueue.print();
 
         //  3: backend dev
         cout << "\n 3: Creating and adding Senior backend dev\n";
-        BackendDeveloper* bd1 = new BackendDeveloper("John Mchedeli", 1003, 36,
+        EmployeeHandle bd1 = pool.create<BackendDeveloper>("John Mchedeli", 1003, 36,
             QualificationLevel::SENIOR, BackendTechnology::NET);
-        printEmployeeDetails(bd1);
-        employeeQueue.insert(bd1);
+        printEmployeeDetails(bd1.get());
+        employeeQueue.insert(move(bd1));
         cout << "\npriority queue after step 3:\n";
         employeeQueue.print();
 
         //  4: middle backend dev
         cout << "\n 4: Creating and adding Middle backend dev\n";
-        BackendDeveloper* bd2 = new BackendDeveloper("Chemi Kurseli", 1004, 24,
+        EmployeeHandle bd2 = pool.create<BackendDeveloper>("Chemi Kurseli", 1004, 24,
             QualificationLevel::MIDDLE, BackendTechnology::SPRING);
-        printEmployeeDetails(bd2);
-        employeeQueue.insert(bd2);
+        printEmployeeDetails(bd2.get());
+        employeeQueue.insert(move(bd2));
         cout << "\npriority queue after step 4:\n";
         employeeQueue.print();
 
         //  5: Sr. frontend dev
         cout << "\n 5: Creating and adding Senior frontend dev\n";
-        FrontendDeveloper* fd1 = new FrontendDeveloper("Boo boba", 1005, 30,
+        EmployeeHandle fd1 = pool.create<FrontendDeveloper>("Boo boba", 1005, 30,
             QualificationLevel::SENIOR, FrontendTechnology::REACT);
-        printEmployeeDetails(fd1);
-        employeeQueue.insert(fd1);
+        printEmployeeDetails(fd1.get());
+        employeeQueue.insert(move(fd1));
         cout << "\npriority queue after step 5:\n";
         employeeQueue.print();
 
         //  6: Junior drontend dev
         cout << "\n 6: Creating and adding Junior drontend dev\n";
-        FrontendDeveloper* fd2 = new FrontendDeveloper("Shrek Movie", 1006, 18,
+        EmployeeHandle fd2 = pool.create<FrontendDeveloper>("Shrek Movie", 1006, 18,
             QualificationLevel::JUNIOR, FrontendTechnology::ANGULAR);
-        printEmployeeDetails(fd2);
-        employeeQueue.insert(fd2);
+        printEmployeeDetails(fd2.get());
+        employeeQueue.insert(move(fd2));
         cout << "\npriority queue after step 6:\n";
         employeeQueue.print();
 
         //  7: senior database eng
         cout << "\n 7: Creating and adding Senior database engineer\n";
-        DatabaseEngineer* dbe = new DatabaseEngineer("Rob Banks", 1007, 42,
+        EmployeeHandle dbe = pool.create<DatabaseEngineer>("Rob Banks", 1007, 42,
             QualificationLevel::SENIOR);
-        printEmployeeDetails(dbe);
-        employeeQueue.insert(dbe);
+        printEmployeeDetails(dbe.get());
+        employeeQueue.insert(move(dbe));
         cout << "\npriority queue after step 7:\n";
         employeeQueue.print();
 
         //  8: Create and add devops eng
         cout << "\n 8: Creating and adding Middle DevOps engineer\n";
-        DevOpsEngineer* devops = new DevOpsEngineer("Research paper", 1008, 36,
+        EmployeeHandle devops = pool.create<DevOpsEngineer>("Research paper", 1008, 36,
             QualificationLevel::MIDDLE);
-        printEmployeeDetails(devops);
-        employeeQueue.insert(devops);
+        printEmployeeDetails(devops.get());
+        employeeQueue.insert(move(devops));
         cout << "\npriority queue after step 8:\n";
         employeeQueue.print();
 
         //  9: Create and add tester
         cout << "\n 9: Creating and adding Middle tester\n";
-        Tester* tester1 = new Tester("Harry Styles", 1009, 24,
+        EmployeeHandle tester1 = pool.create<Tester>("Harry Styles", 1009, 24,
             QualificationLevel::MIDDLE);
-        printEmployeeDetails(tester1);
-        employeeQueue.insert(tester1);
+        printEmployeeDetails(tester1.get());
+        employeeQueue.insert(move(tester1));
         cout << "\npriority queue after step 9:\n";
         employeeQueue.print();
 
         //  10: Create and add another tester to reach 10
         cout << "\n 10: Creating and adding Junior tester\n";
-        Tester* tester2 = new Tester("Final Exams", 1010, 12,
+        EmployeeHandle tester2 = pool.create<Tester>("Final Exams", 1010, 12,
             QualificationLevel::JUNIOR);
-        printEmployeeDetails(tester2);
-        employeeQueue.insert(tester2);
+        printEmployeeDetails(tester2.get());
+        employeeQueue.insert(move(tester2));
         cout << "\npriority queue after step 10:\n";
         employeeQueue.print();
 
@@ -138,12 +213,11 @@ int main() {
 
         // extractMax = peek + pop
         cout << "\nRemoving the highest paid employee:\n";
-        Employee* highestPaid = employeeQueue.extractMax();
+        EmployeeHandle highestPaid = employeeQueue.extractMax(); //freed when the handle goes out of scope
         if (highestPaid) {
-            printEmployeeDetails(highestPaid);
+            printEmployeeDetails(highestPaid.get());
             cout << "\nPriority queue after extraction:\n";
             employeeQueue.print();
-            delete highestPaid;
         }
 
 
@@ -157,19 +231,20 @@ int main() {
         int id = getValidInput<int>("Enter employee'd ID: ");
         int experience = getValidInput<int>("Enter employee's experience in months: ");
 
-        int levelChoice = getValidInput<int>(
-            "Enter level (0 junior, 1 middle, 2 senior): ");
+        int levelChoice = getValidChoice(
+            "Enter level (0 junior, 1 middle, 2 senior): ", static_cast<int>(QualificationLevelCount));
         QualificationLevel level = static_cast<QualificationLevel>(levelChoice);
 
-        int techChoice = getValidInput<int>(
-            "Enter technology (0 .NET, 1 Spring, 2 Django): ");
+        int techChoice = getValidChoice(
+            "Enter technology (0 .NET, 1 Spring, 2 Django): ", static_cast<int>(TechnologyCount));
         BackendTechnology tech = static_cast<BackendTechnology>(techChoice);
 
         try {
-            BackendDeveloper* newDev = new BackendDeveloper(name, id, experience, level, tech);
-            employeeQueue.insert(newDev);
+            EmployeeHandle newDev = pool.create<BackendDeveloper>(name, id, experience, level, tech);
+            const Employee* added = newDev.get(); //the queue owns it after insert, keep a pointer for printing
+            employeeQueue.insert(move(newDev));
             cout << "\nnewest employee added successfully!\n";
-            printEmployeeDetails(newDev);
+            printEmployeeDetails(added);
             cout << "\nFINAL priority queue after adding new employee:\n";
             employeeQueue.print();
         }
@@ -182,8 +257,7 @@ int main() {
 
         try {
             cout << "Trying to create an employee with an invalid ID...\n";
-            CIO* invalidCIO = new CIO("invalid", -1, 12);
-            delete invalidCIO;
+            EmployeeHandle invalidCIO = pool.create<CIO>("invalid", -1, 12);
         }
         catch (const exception& e) {
             cout << "caught expected error: " << e.what() << endl;
@@ -191,13 +265,81 @@ int main() {
 
         try {
             cout << "Trying to create an employee with an invalid experience...\n";
-            ProjectManager* invalidPM = new ProjectManager("Invalid", 9999, -6);
-            delete invalidPM;
+            EmployeeHandle invalidPM = pool.create<ProjectManager>("Invalid", 9999, -6);
+        }
+        catch (const exception& e) {
+            cout << "caught expected error: " << e.what() << endl;
+        }
+
+        // setSalaryPolicy refuses a zero rate, so the loader has to as well
+        try {
+            cout << "Trying to load a salary policy with a zero multiplier...\n";
+            istringstream zero("multiplier SENIOR 0\n");
+            loadSalaryPolicy(zero, "zero.policy");
+            cout << "ERROR: it loaded\n";
+        }
+        catch (const exception& e) {
+            cout << "caught expected error: " << e.what() << endl;
+        }
+
+        // a snapshot cut short inside its records has to be refused, not read past the end of the mapping
+        {
+            cout << "Trying to open a truncated snapshot...\n";
+            char path[] = "/tmp/employee_snapshot_XXXXXX";
+            int fd = mkstemp(path);
+            if (fd >= 0) {
+                close(fd);
+                employeeQueue.save(path);
+                //the header still counts every record, but the last two are gone. with the names section also
+                //claimed empty, only the record count check can catch it
+                off_t cut = static_cast<off_t>(sizeof(SnapshotHeader) + (employeeQueue.size() - 2) * sizeof(SnapshotRecord));
+                int file = open(path, O_RDWR);
+                uint64_t noNames = 0;
+                bool damaged = file >= 0 && ftruncate(file, cut) == 0 &&
+                               pwrite(file, &noNames, sizeof(noNames), offsetof(SnapshotHeader, namesSize)) == sizeof(noNames);
+                if (file >= 0) {
+                    close(file);
+                }
+                if (damaged) {
+                    try {
+                        EmployeeSnapshot truncated(path);
+                        cout << "ERROR: it opened\n";
+                    }
+                    catch (const runtime_error&) {
+                        cout << "caught expected error: snapshot is truncated or corrupt" << endl; //what() has the temp path
+                    }
+                }
+                remove(path);
+            }
+        }
+
+        // a level past SENIOR would index the queue's payroll groups and postings out of range
+        try {
+            cout << "Trying to insert a developer with an unknown level...\n";
+            employeeQueue.insert(pool.create<BackendDeveloper>("Invalid", 9998, 12,
+                static_cast<QualificationLevel>(7), BackendTechnology::NET));
+            cout << "ERROR: it was inserted\n";
         }
         catch (const exception& e) {
             cout << "caught expected error: " << e.what() << endl;
         }
 
+        {
+            cout << "Trying the same through the error code path...\n";
+            EmployeeSpec spec;
+            spec.name = "Invalid";
+            spec.id = 9998;
+            spec.eClass = EmployeeClass::TST;
+            spec.level = static_cast<QualificationLevel>(7);
+            size_t before = employeeQueue.size();
+            EmployeeResult result = pool.tryCreate(spec);
+            EmployeeError error = result.error != EmployeeError::NONE ? result.error
+                                                                      : employeeQueue.tryInsert(move(result.employee));
+            cout << (error == EmployeeError::UNKNOWN_LEVEL && employeeQueue.size() == before ? "rejected as expected: "
+                                                                                                : "ERROR: not rejected: ")
+                 << employeeErrorMessage(error) << endl;
+        }
+
         // Final output
         cout << "(actual) final priority queue contents:\n";
         employeeQueue.print();